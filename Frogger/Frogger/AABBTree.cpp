@@ -0,0 +1,251 @@
+#include "AABBTree.h"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+
+AABB merge(const AABB& a, const AABB& b) {
+    return AABB{
+        sf::Vector2f(std::min(a.min.x, b.min.x), std::min(a.min.y, b.min.y)),
+        sf::Vector2f(std::max(a.max.x, b.max.x), std::max(a.max.y, b.max.y)) };
+}
+
+
+// slab method, the entry is the latest of the two axes' entries and the
+// exit the earliest of their exits
+std::optional<float> AABB::raycast(sf::Vector2f from, sf::Vector2f to, float limit) const {
+    const sf::Vector2f d = to - from;
+    float enter{ 0.f };
+    float exit{ limit };
+
+    const float origin[2]{ from.x, from.y };
+    const float delta[2]{ d.x, d.y };
+    const float lo[2]{ min.x, min.y };
+    const float hi[2]{ max.x, max.y };
+    for (int axis{ 0 }; axis < 2; ++axis) {
+        if (delta[axis] == 0.f) {
+            if (origin[axis] < lo[axis] || origin[axis] > hi[axis])
+                return std::nullopt;
+            continue;
+        }
+        const float inv = 1.f / delta[axis];
+        float t0 = (lo[axis] - origin[axis]) * inv;
+        float t1 = (hi[axis] - origin[axis]) * inv;
+        if (t0 > t1)
+            std::swap(t0, t1);
+        enter = std::max(enter, t0);
+        exit = std::min(exit, t1);
+        if (enter > exit)
+            return std::nullopt;
+    }
+    return enter;
+}
+
+
+int32_t AABBTree::allocate() {
+    if (m_free == NONE) {
+        m_nodes.emplace_back();
+        return static_cast<int32_t>(m_nodes.size() - 1);
+    }
+    const int32_t index = m_free;
+    m_free = m_nodes[index].parent;
+    m_nodes[index] = Node{};
+    return index;
+}
+
+
+void AABBTree::release(int32_t index) {
+    m_nodes[index].parent = m_free;
+    m_nodes[index].height = -1;
+    m_free = index;
+}
+
+
+AABB AABBTree::fatten(const AABB& box, sf::Vector2f displacement) const {
+    // stretched ahead of where the box is going, a few updates' worth
+    const sf::Vector2f margin(m_margin, m_margin);
+    AABB fat{ box.min - margin, box.max + margin };
+    const sf::Vector2f ahead = 4.f * displacement;
+    (ahead.x < 0.f ? fat.min.x : fat.max.x) += ahead.x;
+    (ahead.y < 0.f ? fat.min.y : fat.max.y) += ahead.y;
+    return fat;
+}
+
+
+int32_t AABBTree::create(const AABB& box, uint32_t data) {
+    const int32_t leaf = allocate();
+    m_nodes[leaf].box = fatten(box, {});
+    m_nodes[leaf].data = data;
+    insertLeaf(leaf);
+    ++m_leaves;
+    return leaf;
+}
+
+
+void AABBTree::destroy(int32_t proxy) {
+    removeLeaf(proxy);
+    release(proxy);
+    --m_leaves;
+}
+
+
+bool AABBTree::move(int32_t proxy, const AABB& box, sf::Vector2f displacement) {
+    const AABB& fat = m_nodes[proxy].box;
+    if (fat.contains(box)) {
+        // left alone unless it has shrunk well inside, a box that stopped
+        // would otherwise keep the stretch of its last move for ever
+        const float slack = 4.f * (m_margin + std::abs(displacement.x) + std::abs(displacement.y));
+        const AABB loose{ box.min - sf::Vector2f(slack, slack), box.max + sf::Vector2f(slack, slack) };
+        if (loose.contains(fat))
+            return false;
+    }
+
+    removeLeaf(proxy);
+    m_nodes[proxy].box = fatten(box, displacement);
+    insertLeaf(proxy);
+    return true;
+}
+
+
+void AABBTree::clear() {
+    m_nodes.clear();
+    m_root = NONE;
+    m_free = NONE;
+    m_leaves = 0;
+}
+
+
+void AABBTree::insertLeaf(int32_t leaf) {
+    if (m_root == NONE) {
+        m_root = leaf;
+        m_nodes[leaf].parent = NONE;
+        return;
+    }
+
+    // walk down to the sibling that makes the tree grow the least: going
+    // into a child costs the growth of every node above it plus what the
+    // child itself would gain, pairing with this node costs its union
+    const AABB box = m_nodes[leaf].box;
+    int32_t index = m_root;
+    while (!m_nodes[index].isLeaf()) {
+        const Node& node = m_nodes[index];
+        const float area = node.box.perimeter();
+        const float combined = merge(node.box, box).perimeter();
+        const float pair = 2.f * combined;
+        const float inherited = 2.f * (combined - area);
+
+        auto descend = [&](int32_t child) {
+            const AABB grown = merge(m_nodes[child].box, box);
+            if (m_nodes[child].isLeaf())
+                return grown.perimeter() + inherited;
+            return grown.perimeter() - m_nodes[child].box.perimeter() + inherited;
+        };
+        const float left = descend(node.left);
+        const float right = descend(node.right);
+
+        if (pair < left && pair < right)
+            break;
+        index = left < right ? node.left : node.right;
+    }
+
+    const int32_t sibling = index;
+    const int32_t oldParent = m_nodes[sibling].parent;
+    const int32_t parent = allocate();
+    m_nodes[parent].parent = oldParent;
+    m_nodes[parent].box = merge(box, m_nodes[sibling].box);
+    m_nodes[parent].height = m_nodes[sibling].height + 1;
+    m_nodes[parent].left = sibling;
+    m_nodes[parent].right = leaf;
+    m_nodes[sibling].parent = parent;
+    m_nodes[leaf].parent = parent;
+
+    if (oldParent == NONE)
+        m_root = parent;
+    else if (m_nodes[oldParent].left == sibling)
+        m_nodes[oldParent].left = parent;
+    else
+        m_nodes[oldParent].right = parent;
+
+    refit(m_nodes[leaf].parent);
+}
+
+
+void AABBTree::removeLeaf(int32_t leaf) {
+    if (leaf == m_root) {
+        m_root = NONE;
+        return;
+    }
+
+    // the sibling takes the place of the parent
+    const int32_t parent = m_nodes[leaf].parent;
+    const int32_t grandParent = m_nodes[parent].parent;
+    const int32_t sibling = m_nodes[parent].left == leaf ? m_nodes[parent].right : m_nodes[parent].left;
+    release(parent);
+
+    m_nodes[sibling].parent = grandParent;
+    if (grandParent == NONE) {
+        m_root = sibling;
+        return;
+    }
+    if (m_nodes[grandParent].left == parent)
+        m_nodes[grandParent].left = sibling;
+    else
+        m_nodes[grandParent].right = sibling;
+    refit(grandParent);
+}
+
+
+// boxes and heights from index up to the root, rotating on the way
+void AABBTree::refit(int32_t index) {
+    while (index != NONE) {
+        rotate(index);
+        Node& node = m_nodes[index];
+        const Node& left = m_nodes[node.left];
+        const Node& right = m_nodes[node.right];
+        node.height = 1 + std::max(left.height, right.height);
+        node.box = merge(left.box, right.box);
+        index = node.parent;
+    }
+}
+
+
+// Looks for a grandchild of index that would be better off swapped with
+// its uncle, the other child of index: the swap that shrinks the perimeter
+// of the child it changes the most, if any does. Only that child's box and
+// height change, index keeps its own.
+void AABBTree::rotate(int32_t index) {
+    Node& node = m_nodes[index];
+    if (node.isLeaf())
+        return;
+
+    float bestGain{ 0.f };
+    int32_t uncle{ NONE };
+    int32_t nephew{ NONE };
+    auto consider = [&](int32_t outer, int32_t inner) {
+        if (m_nodes[inner].isLeaf())
+            return;
+        const Node& child = m_nodes[inner];
+        for (const int32_t grandChild : { child.left, child.right }) {
+            const int32_t stays = grandChild == child.left ? child.right : child.left;
+            const float gain = child.box.perimeter() - merge(m_nodes[outer].box, m_nodes[stays].box).perimeter();
+            if (gain > bestGain) {
+                bestGain = gain;
+                uncle = outer;
+                nephew = grandChild;
+            }
+        }
+    };
+    consider(node.left, node.right);
+    consider(node.right, node.left);
+    if (uncle == NONE)
+        return;
+
+    const int32_t child = m_nodes[nephew].parent;
+    Node& changed = m_nodes[child];
+    (changed.left == nephew ? changed.left : changed.right) = uncle;
+    (node.left == uncle ? node.left : node.right) = nephew;
+    m_nodes[uncle].parent = child;
+    m_nodes[nephew].parent = index;
+    changed.box = merge(m_nodes[changed.left].box, m_nodes[changed.right].box);
+    changed.height = 1 + std::max(m_nodes[changed.left].height, m_nodes[changed.right].height);
+}
@@ -0,0 +1,170 @@
+#ifndef BREAKOUT_AABBTREE_H
+#define BREAKOUT_AABBTREE_H
+
+
+#include <SFML/System/Vector2.hpp>
+#include <vector>
+#include <array>
+#include <optional>
+#include <cstdint>
+
+
+// axis aligned box by its corners, touching boxes do not overlap
+struct AABB {
+    sf::Vector2f        min;
+    sf::Vector2f        max;
+
+    static AABB         around(sf::Vector2f center, sf::Vector2f halfSize) { return AABB{ center - halfSize, center + halfSize }; }
+
+    bool                overlaps(const AABB& other) const {
+        return min.x < other.max.x && other.min.x < max.x && min.y < other.max.y && other.min.y < max.y;
+    }
+    bool                contains(const AABB& other) const {
+        return min.x <= other.min.x && min.y <= other.min.y && other.max.x <= max.x && other.max.y <= max.y;
+    }
+    float               perimeter() const { return 2.f * ((max.x - min.x) + (max.y - min.y)); }
+
+    // where the segment from + (to - from) t, t in [0, limit], enters the
+    // box, 0 if it starts inside
+    std::optional<float> raycast(sf::Vector2f from, sf::Vector2f to, float limit = 1.f) const;
+};
+
+AABB merge(const AABB& a, const AABB& b);
+
+
+// Bounding volume hierarchy over boxes that move, grow and go away.
+// Every leaf holds a fat box, the tight one plus a margin and some of
+// its last displacement, and move() only reinserts a leaf once the tight
+// box leaves it, so most updates cost nothing. Inserts pick the sibling
+// that adds the least perimeter, and on the way back up every node may
+// swap a child with a grandchild when that shrinks the boxes below it,
+// which undoes most of what a bad insert order does to the tree. Perimeter
+// is what a query pays for, a box is entered about in proportion to it.
+// Nodes live in one vector and are recycled through a free list.
+class AABBTree {
+public:
+    static constexpr int32_t NONE{ -1 };
+
+private:
+    // the queries keep their own stack of this size, fifty thousand
+    // boxes make a tree some twenty five deep
+    static constexpr size_t MAX_DEPTH{ 256 };
+
+    struct Node {
+        AABB            box;                // fat for a leaf, union of the children otherwise
+        int32_t         parent{ NONE };     // next free node while free
+        int32_t         left{ NONE };
+        int32_t         right{ NONE };
+        int32_t         height{ 0 };        // 0 for a leaf, -1 while free
+        uint32_t        data{ 0 };
+
+        bool            isLeaf() const { return left == NONE; }
+    };
+
+    std::vector<Node>   m_nodes;
+    int32_t             m_root{ NONE };
+    int32_t             m_free{ NONE };
+    size_t              m_leaves{ 0 };
+    float               m_margin;
+
+    int32_t             allocate();
+    void                release(int32_t index);
+    void                insertLeaf(int32_t leaf);
+    void                removeLeaf(int32_t leaf);
+    void                refit(int32_t index);
+    void                rotate(int32_t index);
+    AABB                fatten(const AABB& box, sf::Vector2f displacement) const;
+
+public:
+    explicit AABBTree(float margin = 4.f) : m_margin(margin) {}
+
+    // returns the proxy that stands for the box until destroy()
+    int32_t             create(const AABB& box, uint32_t data);
+    void                destroy(int32_t proxy);
+
+    // the box moved by displacement since the last call, true when the
+    // leaf had to be reinserted
+    bool                move(int32_t proxy, const AABB& box, sf::Vector2f displacement = {});
+
+    void                clear();
+
+    const AABB&         fatBox(int32_t proxy) const { return m_nodes[proxy].box; }
+    uint32_t            data(int32_t proxy) const { return m_nodes[proxy].data; }
+    void                setData(int32_t proxy, uint32_t data) { m_nodes[proxy].data = data; }
+    size_t              size() const { return m_leaves; }
+    int32_t             height() const { return m_root == NONE ? 0 : m_nodes[m_root].height; }
+
+    // f(proxy) for every leaf whose fat box overlaps box, until f returns false
+    template<typename F>
+    void                query(const AABB& box, F&& f) const;
+
+    // f(proxy, limit) for the leaves whose fat box the segment from + (to - from) t
+    // enters before t = limit, nearer ones first where it can tell. f returns
+    // the new limit: the hit fraction to clip the ray, limit to carry on, 0 to stop.
+    template<typename F>
+    void                raycast(sf::Vector2f from, sf::Vector2f to, F&& f) const;
+};
+
+
+template<typename F>
+void AABBTree::query(const AABB& box, F&& f) const {
+    std::array<int32_t, MAX_DEPTH> stack;
+    size_t top{ 0 };
+    if (m_root != NONE)
+        stack[top++] = m_root;
+
+    while (top > 0) {
+        const Node& node = m_nodes[stack[--top]];
+        if (!node.box.overlaps(box))
+            continue;
+
+        if (node.isLeaf()) {
+            if (!f(stack[top]))
+                return;
+        }
+        else {
+            stack[top++] = node.left;
+            stack[top++] = node.right;
+        }
+    }
+}
+
+
+template<typename F>
+void AABBTree::raycast(sf::Vector2f from, sf::Vector2f to, F&& f) const {
+    std::array<int32_t, MAX_DEPTH> stack;
+    size_t top{ 0 };
+    if (m_root != NONE)
+        stack[top++] = m_root;
+
+    float limit{ 1.f };
+    while (top > 0) {
+        const int32_t index = stack[--top];
+        const Node& node = m_nodes[index];
+        if (!node.box.raycast(from, to, limit))
+            continue;
+
+        if (node.isLeaf()) {
+            limit = f(index, limit);
+            if (limit <= 0.f)
+                return;
+            continue;
+        }
+
+        // the child the ray enters first is searched first, it may clip the other
+        const auto left = m_nodes[node.left].box.raycast(from, to, limit);
+        const auto right = m_nodes[node.right].box.raycast(from, to, limit);
+        if (left && right) {
+            const bool leftFirst = *left <= *right;
+            stack[top++] = leftFirst ? node.right : node.left;
+            stack[top++] = leftFirst ? node.left : node.right;
+        }
+        else if (left)
+            stack[top++] = node.left;
+        else if (right)
+            stack[top++] = node.right;
+    }
+}
+
+
+#endif //BREAKOUT_AABBTREE_H
@@ -4,11 +4,12 @@
 
 #include "Animation.h"
 #include "Utilities.h"
+#include <algorithm>
 
 
 Animation::Animation(const std::string& name,
     const sf::Texture& t,
-    std::vector<sf::IntRect> frames,
+    std::span<const sf::IntRect> frames,
     sf::Time tpf,
     bool repeats)
     : m_name(name)
@@ -16,10 +17,8 @@ Animation::Animation(const std::string& name,
     , m_timePerFrame(tpf)
     , m_isRepeating(repeats)
     , m_countDown(tpf)
-    , m_sprite(t, m_frames[0])
+    , m_texture(&t)
 {
-    centerOrigin(m_sprite);
-
     std::cout << name << " tpf: " << m_timePerFrame.asMilliseconds() << "ms\n";
 }
 
@@ -35,9 +34,6 @@ void Animation::update(sf::Time dt) {
             return;  // on the last frame of non-repeating animaton, leave it
         else
             m_currentFrame = (m_currentFrame % m_frames.size());
-
-        m_sprite.setTextureRect(m_frames[m_currentFrame]);
-        centerOrigin(m_sprite);
     }
 }
 
@@ -52,8 +48,13 @@ const std::string& Animation::getName() const {
 }
 
 
-sf::Sprite& Animation::getSprite() {
-    return m_sprite;
+const sf::Texture* Animation::getTexture() const {
+    return m_texture;
+}
+
+
+const sf::IntRect& Animation::getFrame() const {
+    return m_frames[std::min(m_currentFrame, m_frames.size() - 1)];
 }
 
 sf::Vector2f Animation::getBB() const {
@@ -6,29 +6,31 @@
 #define SFMLCLASS_ANIMATION_H
 
 #include <SFML/Graphics.hpp>
+#include <span>
 #include <vector>
 
 class Animation {
 public:
     std::string                 m_name{ "none" };
-    std::vector<sf::IntRect>    m_frames;
+    std::span<const sf::IntRect> m_frames;     // owned by Assets, like the texture, so copies are cheap
     sf::Time                    m_timePerFrame;
     size_t                      m_currentFrame{ 0 };
     sf::Time                    m_countDown{ sf::Time::Zero };
     bool                        m_isRepeating{ true };
     bool                        m_hasEnded{ false };
-    sf::Sprite                  m_sprite;
+    const sf::Texture*          m_texture{ nullptr };
 
 
 public:
     Animation() = default;
     Animation(const std::string& name, const sf::Texture& t,
-        std::vector<sf::IntRect> frames, sf::Time tpf, bool repeats = true);
+        std::span<const sf::IntRect> frames, sf::Time tpf, bool repeats = true);
 
     void                    update(sf::Time dt);
     bool                    hasEnded() const;
     const std::string& getName() const;
-    sf::Sprite& getSprite();
+    const sf::Texture*      getTexture() const;
+    const sf::IntRect&      getFrame() const;       // the frame to draw, the last one once ended
     sf::Vector2f            getBB() const;
 };
 
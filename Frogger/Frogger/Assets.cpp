@@ -4,9 +4,12 @@
 
 #include "Assets.h"
 #include "MusicPlayer.h"
+#include "JobSystem.h"
+#include "Profiler.h"
 #include <iostream>
 #include <cassert>
 #include <fstream>
+#include <algorithm>
 #include "json.hpp"
 
 Assets::Assets() {
@@ -42,8 +45,19 @@ void Assets::addSound(const std::string& soundName, const std::string& path) {
 }
 
 void Assets::addTexture(const std::string& textureName, const std::string& path, bool smooth) {
+    sf::Image image;
+    if (!image.loadFromFile(path)) {
+        std::cerr << "Could not load texture file: " << path << std::endl;
+        return;
+    }
+    addTexture(textureName, image, path, smooth);
+}
+
+// the upload talks to OpenGL, main thread only
+void Assets::addTexture(const std::string& textureName, const sf::Image& image, const std::string& path, bool smooth) {
+    assert(JobSystem::getInstance().isMainThread());
     m_textures[textureName] = sf::Texture();
-    if (!m_textures[textureName].loadFromFile(path)) {
+    if (!m_textures[textureName].loadFromImage(image)) {
         std::cerr << "Could not load texture file: " << path << std::endl;
         m_textures.erase(textureName);
     }
@@ -86,6 +100,8 @@ const Animation& Assets::getAnimation(const std::string& name) const {
 }
 
 void Assets::loadSounds(const std::string& path) {
+    PROFILE_ZONE("Assets::loadSounds");
+
     std::ifstream confFile(path);
     if (confFile.fail()) {
         std::cerr << "Open file " << path << " failed\n";
@@ -113,6 +129,8 @@ void Assets::loadSounds(const std::string& path) {
 }
 
 void Assets::loadJson(const std::string& path) {
+    PROFILE_ZONE("Assets::loadJson");
+
     // Read Config file
     std::ifstream confFile(path);
     if (confFile.fail())
@@ -139,6 +157,8 @@ void Assets::loadJson(const std::string& path) {
 
             std::cout << std::setw(4) << data << "\n\n";
 
+            // a reload replaces the sets instead of appending to them
+            std::map<std::string, std::vector<sf::IntRect>> frameSets;
             for (auto i : data) {
 
                 // clean up animation name
@@ -151,7 +171,20 @@ void Assets::loadJson(const std::string& path) {
                 auto ir = sf::IntRect(i["frame"]["x"], i["frame"]["y"],
                     i["frame"]["w"], i["frame"]["h"]);
 
-                m_frameSets[tmp.substr(0, n)].push_back(ir);
+                frameSets[tmp.substr(0, n)].push_back(ir);
+            }
+            // Animations hold spans into the sets, so a set keeps its
+            // storage across reloads: same-sized sets are overwritten in
+            // place, a resized one is retired rather than freed
+            for (auto& [name, frames] : frameSets) {
+                auto& set = m_frameSets[name];
+                if (set.size() == frames.size()) {
+                    std::copy(frames.begin(), frames.end(), set.begin());
+                    continue;
+                }
+                if (!set.empty())
+                    m_retiredFrameSets.push_back(std::move(set));
+                set = std::move(frames);
             }
             f.close();
         }
@@ -168,6 +201,8 @@ void Assets::loadJson(const std::string& path) {
 }
 
 void Assets::loadAnimations(const std::string& path) {
+    PROFILE_ZONE("Assets::loadAnimations");
+
     // Read Config file
     std::ifstream confFile(path);
     if (confFile.fail())
@@ -208,6 +243,8 @@ void Assets::loadAnimations(const std::string& path) {
 
 
 void Assets::loadFonts(const std::string& path) {
+    PROFILE_ZONE("Assets::loadFonts");
+
     std::ifstream confFile(path);
     if (confFile.fail()) {
         std::cerr << "Open file " << path << " failed\n";
@@ -235,6 +272,8 @@ void Assets::loadFonts(const std::string& path) {
 
 
 void Assets::loadTextures(const std::string& path) {
+    PROFILE_ZONE("Assets::loadTextures");
+
     // Read Config file
     std::ifstream confFile(path);
     if (confFile.fail()) {
@@ -243,13 +282,14 @@ void Assets::loadTextures(const std::string& path) {
         exit(1);
     }
 
+    std::vector<std::pair<std::string, std::string>> files;
     std::string token{ "" };
     confFile >> token;
     while (confFile) {
         if (token == "Texture") {
             std::string name, path;
             confFile >> name >> path;
-            addTexture(name, path);
+            files.emplace_back(name, path);
         }
         else {
             // ignore rest of line and continue
@@ -259,9 +299,32 @@ void Assets::loadTextures(const std::string& path) {
         confFile >> token;
     }
     confFile.close();
+
+    if (m_headless) {
+        for (const auto& [name, file] : files)
+            m_textures[name] = sf::Texture();
+        return;
+    }
+
+    // decoding the files is plain CPU work, spread it over the workers
+    std::vector<sf::Image> images(files.size());
+    std::vector<char> decoded(files.size(), 0);
+    JobSystem::getInstance().parallelFor(0, files.size(), 1, [&](size_t first, size_t last) {
+        for (size_t i{ first }; i < last; ++i)
+            decoded[i] = images[i].loadFromFile(files[i].second);
+        });
+
+    for (size_t i{ 0 }; i < files.size(); ++i) {
+        if (decoded[i])
+            addTexture(files[i].first, images[i], files[i].second);
+        else
+            std::cerr << "Could not load texture file: " << files[i].second << std::endl;
+    }
 }
 
 void Assets::loadSprts(const std::string& path) {
+    PROFILE_ZONE("Assets::loadSprts");
+
     // Read Config file
     std::ifstream confFile(path);
     if (confFile.fail()) {
@@ -290,11 +353,22 @@ void Assets::loadSprts(const std::string& path) {
 }
 
 
-void Assets::loadFromFile(const std::string path) {
-    loadFonts(path);
+void Assets::loadFromFile(const std::string path, bool headless) {
+    auto& jobs = JobSystem::getInstance();
+    m_headless = headless;
+
+    // each loader fills its own map, so they can run side by side
+    auto fonts = jobs.submit([this, path] { loadFonts(path); });
+    auto sprites = jobs.submit([this, path] { loadSprts(path); });
+    JobSystem::Handle sounds;   // sound buffers open the audio device
+    if (!m_headless)
+        sounds = jobs.submit([this, path] { loadSounds(path); });
+    auto frames = jobs.submit([this, path] { loadJson(path); });
+
+    // textures are uploaded by this thread
     loadTextures(path);
-    loadSprts(path);
-    loadSounds(path);
-    loadJson(path);
-    loadAnimations(path);  // requires loadJson be run first
+    auto animations = jobs.submit([this, path] { loadAnimations(path); }, { frames });  // requires loadJson be run first
+
+    for (const auto& job : { fonts, sprites, sounds, animations })
+        jobs.wait(job);
 }
@@ -40,6 +40,8 @@ private:
     std::map<std::string, std::unique_ptr<sf::SoundBuffer>>     m_soundEffects;
     std::map<std::string, Animation>                            m_animationMap;
     std::map<std::string, std::vector<sf::IntRect>>             m_frameSets;
+    std::vector<std::vector<sf::IntRect>>                       m_retiredFrameSets;    // resized by a reload, still seen by older Animations
+    bool                                                        m_headless{ false };
 
 
     void loadFonts(const std::string& path);
@@ -48,9 +50,12 @@ private:
     void loadSounds(const std::string& path);
     void loadJson(const std::string& path);
     void loadAnimations(const std::string& path);
+    void addTexture(const std::string& textureName, const sf::Image& image, const std::string& path, bool smooth = true);
 
 public:
-    void loadFromFile(const std::string path);
+    // headless skips everything that needs a GPU or an audio device,
+    // textures are registered empty so animations still find their frames
+    void loadFromFile(const std::string path, bool headless = false);
     void addFont(const std::string& fontName, const std::string& path);
     void addSound(const std::string& soundEffectName, const std::string& path);
     void addTexture(const std::string& textureName, const std::string& path, bool smooth = true);
@@ -0,0 +1,185 @@
+#ifndef BREAKOUT_COMPONENTPOOL_H
+#define BREAKOUT_COMPONENTPOOL_H
+
+
+#include <vector>
+#include <cstdint>
+#include <utility>
+#include <numeric>
+#include <algorithm>
+#include <type_traits>
+
+#include "Snapshot.h"
+#include "MemoryTracker.h"
+
+
+// Sparse set of one component type.
+// Components are packed contiguously in m_dense so a system only walks
+// the entities that actually own a T, m_sparse maps an entity slot to
+// its index in m_dense and m_slots maps the other way.
+template<typename T>
+class ComponentPool {
+public:
+    static constexpr uint32_t npos{ UINT32_MAX };
+
+private:
+    std::vector<uint32_t>   m_sparse;
+    std::vector<uint32_t>   m_slots;
+    std::vector<T>          m_dense;
+    std::vector<uint32_t>   m_order;    // scratch for compact()
+    T                       m_none;     // handed out for slots that have no T
+
+public:
+    bool has(uint32_t slot) const {
+        return slot < m_sparse.size() && m_sparse[slot] != npos;
+    }
+
+
+    template<typename... TArgs>
+    T& emplace(uint32_t slot, TArgs &&... mArgs) {
+        if (slot >= m_sparse.size())
+            m_sparse.resize(slot + 1, npos);
+
+        // replace in place if the slot already owns a T
+        if (m_sparse[slot] != npos) {
+            auto& component = m_dense[m_sparse[slot]];
+            component = T(std::forward<TArgs>(mArgs)...);
+            component.has = true;
+            return component;
+        }
+
+        grow(1);
+        m_sparse[slot] = static_cast<uint32_t>(m_dense.size());
+        m_slots.push_back(slot);
+        auto& component = m_dense.emplace_back(std::forward<TArgs>(mArgs)...);
+        component.has = true;
+        return component;
+    }
+
+
+    // room for extra more components, at least doubling when it runs out;
+    // allowed under ASSERT_NO_ALLOCATIONS, it is paid once per doubling
+    void grow(size_t extra) {
+        if (m_dense.size() + extra <= m_dense.capacity())
+            return;
+        AllocationScope growth;
+        reserve(std::max(m_dense.size() + extra, std::max<size_t>(16, 2 * m_dense.size())));
+    }
+
+
+    // bytes the pool has reserved, heap memory owned by a T is not counted
+    size_t memoryBytes() const {
+        return (m_sparse.capacity() + m_slots.capacity()) * sizeof(uint32_t)
+            + m_dense.capacity() * sizeof(T);
+    }
+
+
+    // swap and pop, the last component fills the hole
+    bool remove(uint32_t slot) {
+        if (!has(slot))
+            return false;
+
+        uint32_t idx = m_sparse[slot];
+        uint32_t last = static_cast<uint32_t>(m_dense.size() - 1);
+        if (idx != last) {
+            m_dense[idx] = std::move(m_dense[last]);
+            m_slots[idx] = m_slots[last];
+            m_sparse[m_slots[idx]] = idx;
+        }
+        m_dense.pop_back();
+        m_slots.pop_back();
+        m_sparse[slot] = npos;
+        return true;
+    }
+
+
+    // entities without a T get a default (has == false) component,
+    // anything written to it is thrown away on the next miss. It is per
+    // thread so systems running in parallel can miss at the same time.
+    T& get(uint32_t slot) {
+        if (!has(slot)) {
+            static thread_local T none;
+            none = T();
+            return none;
+        }
+        return m_dense[m_sparse[slot]];
+    }
+
+
+    const T& get(uint32_t slot) const {
+        return has(slot) ? m_dense[m_sparse[slot]] : m_none;
+    }
+
+
+    // Reorders the dense array by slot, in place, capacity is kept.
+    // Entities that own several components then sit in the same order in
+    // every pool, so views walk memory forwards again after heavy churn.
+    void compact() {
+        m_order.resize(m_slots.size());
+        std::iota(m_order.begin(), m_order.end(), 0);
+        std::sort(m_order.begin(), m_order.end(), [this](uint32_t a, uint32_t b) { return m_slots[a] < m_slots[b]; });
+
+        // m_order[i] is where the component that goes to i is now, each
+        // cycle of that permutation is rotated through one temporary
+        for (uint32_t start{ 0 }; start < m_order.size(); ++start) {
+            if (m_order[start] == npos || m_order[start] == start)
+                continue;
+            T component = std::move(m_dense[start]);
+            const uint32_t slot = m_slots[start];
+            uint32_t i = start;
+            while (m_order[i] != start) {
+                const uint32_t from = m_order[i];
+                m_dense[i] = std::move(m_dense[from]);
+                m_slots[i] = m_slots[from];
+                m_order[i] = npos;
+                i = from;
+            }
+            m_dense[i] = std::move(component);
+            m_slots[i] = slot;
+            m_order[i] = npos;
+        }
+
+        m_sparse.resize(m_slots.empty() ? 0 : m_slots.back() + 1);
+        for (uint32_t i{ 0 }; i < m_slots.size(); ++i)
+            m_sparse[m_slots[i]] = i;
+    }
+
+
+    void save(SnapshotWriter& w) const {
+        w.writeArray(m_sparse);
+        w.writeArray(m_slots);
+        if constexpr (std::is_trivially_copyable_v<T>) {
+            w.writeArray(m_dense);
+        }
+        else {
+            for (const auto& component : m_dense)
+                saveComponent(w, component);
+        }
+    }
+
+
+    void load(SnapshotReader& r) {
+        r.readArray(m_sparse);
+        r.readArray(m_slots);
+        if constexpr (std::is_trivially_copyable_v<T>) {
+            r.readArray(m_dense);
+        }
+        else {
+            m_dense.resize(m_slots.size());
+            for (auto& component : m_dense) {
+                loadComponent(r, component);
+                component.has = true;
+            }
+        }
+    }
+
+
+    size_t                          size() const { return m_dense.size(); }
+    const std::vector<uint32_t>&    slots() const { return m_slots; }
+    T&                              at(size_t idx) { return m_dense[idx]; }
+    void                            reserve(size_t n) { m_dense.reserve(n); m_slots.reserve(n); m_order.reserve(n); }
+    void                            reserveSlots(size_t n) { m_sparse.reserve(n); }     // room for slots below n
+};
+
+
+#endif //BREAKOUT_COMPONENTPOOL_H
@@ -11,6 +11,8 @@
 #include "Utilities.h"
 #include "Animation.h"
 #include <bitset>
+#include <tuple>
+#include <array>
 
 
 struct Component
@@ -48,7 +50,6 @@ struct CSprite : public Component {
 struct CTransform : public Component
 {
 
-    sf::Transformable  tfm;
     sf::Vector2f	pos{ 0.f, 0.f };
     sf::Vector2f	prevPos{ 0.f, 0.f };
     sf::Vector2f	vel{ 0.f, 0.f };
@@ -100,4 +101,12 @@ struct CInput : public Component
 };
 
 
+// every component type, EntityManager keeps one pool per entry
+using ComponentTuple = std::tuple<CSprite, CAnimation, CState, CTransform, CBoundingBox, CInput>;
+
+// for reports, in ComponentTuple order
+inline constexpr std::array<const char*, std::tuple_size_v<ComponentTuple>> COMPONENT_NAMES{
+    "CSprite", "CAnimation", "CState", "CTransform", "CBoundingBox", "CInput" };
+
+
 #endif //BREAKOUT_COMPONENTS_H
@@ -4,48 +4,295 @@
 
 #include "EntityManager.h"
 #include "Entity.h"
+#include "MemoryTracker.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <functional>
+#include <type_traits>
+
+namespace {
+    template<typename T>
+    void reservePool(ComponentPool<T>& pool, const Prefab& prefab, size_t n, bool transforms) {
+        // instances get a CTransform, with or without one in the prefab
+        if (prefab.get<T>() || (transforms && std::is_same_v<T, CTransform>))
+            pool.grow(n);
+    }
+
+
+    template<typename T>
+    void stampPool(ComponentPool<T>& pool, const Prefab& prefab, uint32_t slot) {
+        if (const auto& component = prefab.get<T>())
+            pool.emplace(slot, *component);
+    }
+}
 
-EntityManager::EntityManager() : m_totalEntities(0) {}
 
+EntityManager::EntityManager()
+    : m_entityBuckets(TagRegistry::getInstance().size())
+    , m_totalEntities(0) {}
 
-std::shared_ptr<Entity> EntityManager::addEntity(const std::string& tag) {
-    // create a new Entity object
-    auto e = std::shared_ptr<Entity>(new Entity(m_totalEntities++, tag));
+
+Entity EntityManager::addEntity(const std::string& tag) {
+    return addEntity(TagRegistry::getInstance().intern(tag));
+}
+
+
+Entity EntityManager::addEntity(TagId tag) {
+    // reuse a free slot so the pools' sparse arrays stay bounded
+    uint32_t index;
+    if (!m_freeSlots.empty()) {
+        index = m_freeSlots.back();
+        m_freeSlots.pop_back();
+    }
+    else {
+        index = static_cast<uint32_t>(m_slots.size());
+        assert(index <= Entity::INDEX_MASK);
+        if (m_slots.size() == m_slots.capacity())
+            reserve(std::max<size_t>(64, 2 * m_slots.size()));
+        m_slots.emplace_back();
+    }
+
+    auto& slot = m_slots[index];
+    slot.id = m_totalEntities++;
+    slot.tag = tag;
+    slot.active = true;
+
+    // create a new Entity handle
+    Entity e(this, index, slot.generation);
 
     // store it in entities vector
     m_EntitiesToAdd.push_back(e);
-    // return shared pointer to it
     return e;
 }
 
 
-EntityVec& EntityManager::getEntities(const std::string& tag) {
-    return m_entityMap[tag];
+PrefabId EntityManager::definePrefab(Prefab prefab) {
+    m_prefabs.push_back(std::move(prefab));
+    return static_cast<PrefabId>(m_prefabs.size() - 1);
+}
+
+
+const Prefab& EntityManager::getPrefab(PrefabId id) const {
+    return m_prefabs.at(id);
+}
+
+
+EntitySpan EntityManager::instantiate(const Prefab& prefab, std::span<const PrefabInstance> instances) {
+    const size_t first = m_EntitiesToAdd.size();
+    m_EntitiesToAdd.reserve(first + instances.size());
+    std::apply([&](auto&... pool) { (reservePool(pool, prefab, instances.size(), true), ...); }, m_pools);
+
+    auto& transforms = getPool<CTransform>();
+    for (const auto& instance : instances) {
+        Entity e = addEntity(prefab.tag());
+        std::apply([&](auto&... pool) { (stampPool(pool, prefab, e.index()), ...); }, m_pools);
+
+        auto& tfm = transforms.has(e.index()) ? transforms.get(e.index()) : transforms.emplace(e.index());
+        tfm.pos = instance.pos;
+        tfm.prevPos = instance.pos;
+        tfm.vel = instance.vel;
+    }
+
+    return EntitySpan(m_EntitiesToAdd).subspan(first);
+}
+
+
+Entity EntityManager::instantiate(const Prefab& prefab, const PrefabInstance& instance) {
+    return instantiate(prefab, std::span<const PrefabInstance>(&instance, 1)).front();
+}
+
+
+EntitySpan EntityManager::instantiate(const Prefab& prefab, size_t count) {
+    const size_t first = m_EntitiesToAdd.size();
+    m_EntitiesToAdd.reserve(first + count);
+    std::apply([&](auto&... pool) { (reservePool(pool, prefab, count, false), ...); }, m_pools);
+
+    for (size_t i{ 0 }; i < count; ++i) {
+        Entity e = addEntity(prefab.tag());
+        std::apply([&](auto&... pool) { (stampPool(pool, prefab, e.index()), ...); }, m_pools);
+    }
+
+    return EntitySpan(m_EntitiesToAdd).subspan(first);
+}
+
+
+EntitySpan EntityManager::getEntities(TagId tag) {
+    if (tag >= m_entityBuckets.size())
+        return {};
+    return m_entityBuckets[tag];
+}
+
+
+CommandBuffer& EntityManager::commands(size_t stream) {
+    std::lock_guard<std::mutex> lock(m_commandMutex);
+    while (m_commandBuffers.size() <= stream)
+        m_commandBuffers.push_back(std::make_unique<CommandBuffer>());
+    return *m_commandBuffers[stream];
 }
 
 
 void EntityManager::update() {
-    // Remove dead entities
-    removeDeadEntities(m_entities);
-    for (auto& [_, entityVec] : m_entityMap)
-        removeDeadEntities(entityVec);
+    PROFILE_ZONE("EntityManager::update");
 
+    // play back deferred commands, spawns join the pending entities below
+    for (auto& buffer : m_commandBuffers)
+        buffer->playback(*this);
 
-    // add new entities
+    // add new entities, an entity destroyed before it was added is
+    // added and removed below without ever being visible
     for (auto e : m_EntitiesToAdd)
     {
+        auto& slot = m_slots[e.index()];
+
+        // tags interned after construction get their bucket here; a bucket
+        // doubles when full, so together they hold about what m_entities does
+        if (slot.tag >= m_entityBuckets.size()) {
+            AllocationScope growth;
+            m_entityBuckets.resize(slot.tag + 1);
+        }
+        auto& bucket = m_entityBuckets[slot.tag];
+        if (bucket.size() == bucket.capacity()) {
+            AllocationScope growth;
+            bucket.reserve(std::max<size_t>(64, 2 * bucket.size()));
+        }
+
+        slot.entityPos = static_cast<uint32_t>(m_entities.size());
+        slot.bucketPos = static_cast<uint32_t>(bucket.size());
         m_entities.push_back(e);
-        m_entityMap[e->getTag()].push_back(e);
+        bucket.push_back(e);
+        slot.alive = true;
     }
     m_EntitiesToAdd.clear();
+
+    // Remove dead entities, nothing to do if nobody died
+    if (m_dead.empty())
+        return;
+
+    const size_t live = m_entities.size();
+    const size_t removed = m_dead.size();
+    for (auto index : m_dead)
+        removeEntity(index);
+    m_dead.clear();
+
+    if (m_compactionRatio > 0.f && removed >= m_compactionRatio * live)
+        compact();
+}
+
+
+void EntityManager::compact() {
+    std::apply([](auto&... pool) { (pool.compact(), ...); }, m_pools);
+
+    // hand out the lowest free slots first so the sparse arrays stay short
+    std::sort(m_freeSlots.begin(), m_freeSlots.end(), std::greater<>());
+}
+
+
+void EntityManager::reserve(size_t n) {
+    // growth is allowed wherever it happens, it is paid once per doubling
+    AllocationScope growth;
+
+    m_slots.reserve(n);
+    m_freeSlots.reserve(n);
+    m_dead.reserve(n);
+    m_EntitiesToAdd.reserve(n);
+    m_entities.reserve(n);
+    if (m_entityBuckets.size() < TagRegistry::getInstance().size())
+        m_entityBuckets.resize(TagRegistry::getInstance().size());
+    std::apply([n](auto&... pool) { (pool.reserveSlots(n), ...); }, m_pools);
+}
+
+
+void EntityManager::setCompactionRatio(float ratio) {
+    m_compactionRatio = ratio;
+}
+
+
+void EntityManager::componentMemory(std::vector<size_t>& bytes) const {
+    bytes.clear();
+    std::apply([&bytes](const auto&... pool) { (bytes.push_back(pool.memoryBytes()), ...); }, m_pools);
+}
+
+
+void EntityManager::save(SnapshotWriter& w) const {
+    w.write(m_totalEntities);
+    w.writeArray(m_slots);
+    w.writeArray(m_freeSlots);
+    w.writeArray(m_dead);
+
+    // laid out like writeArray() of their slots
+    w.write(static_cast<uint32_t>(m_EntitiesToAdd.size()));
+    for (auto e : m_EntitiesToAdd)
+        w.write(e.index());
+
+    std::apply([&w](const auto&... pool) { (pool.save(w), ...); }, m_pools);
+}
+
+
+void EntityManager::load(SnapshotReader& r) {
+    m_totalEntities = r.read<size_t>();
+    r.readArray(m_slots);
+    r.readArray(m_freeSlots);
+    r.readArray(m_dead);
+
+    m_EntitiesToAdd.clear();
+    const uint32_t pending = r.read<uint32_t>();
+    for (uint32_t i{ 0 }; i < pending; ++i)
+        m_EntitiesToAdd.push_back(entityAt(r.read<uint32_t>()));
+
+    // every alive slot knows where it sits in m_entities and its bucket
+    m_entities.clear();
+    for (auto& bucket : m_entityBuckets)
+        bucket.clear();
+    for (uint32_t index{ 0 }; index < m_slots.size(); ++index) {
+        const auto& slot = m_slots[index];
+        if (!slot.alive)
+            continue;
+
+        if (slot.entityPos >= m_entities.size())
+            m_entities.resize(slot.entityPos + 1);
+        m_entities[slot.entityPos] = entityAt(index);
+
+        if (slot.tag >= m_entityBuckets.size())
+            m_entityBuckets.resize(slot.tag + 1);
+        auto& bucket = m_entityBuckets[slot.tag];
+        if (slot.bucketPos >= bucket.size())
+            bucket.resize(slot.bucketPos + 1);
+        bucket[slot.bucketPos] = entityAt(index);
+    }
+
+    std::apply([&r](auto&... pool) { (pool.load(r), ...); }, m_pools);
 }
 
 
-EntityVec& EntityManager::getEntities() {
+EntitySpan EntityManager::getEntities() {
     return m_entities;
 }
 
 
-void EntityManager::removeDeadEntities(EntityVec& v) {
-    v.erase(std::remove_if(v.begin(), v.end(), [](auto e) {return!(e->isActive()); }), v.end());
+void EntityManager::removeEntity(uint32_t index) {
+    auto& slot = m_slots[index];
+    swapAndPop(m_entities, slot.entityPos, &Slot::entityPos);
+    swapAndPop(m_entityBuckets[slot.tag], slot.bucketPos, &Slot::bucketPos);
+    releaseSlot(index);
+}
+
+
+// the last entity fills the hole, its back reference follows it
+void EntityManager::swapAndPop(EntityVec& v, uint32_t pos, uint32_t Slot::* backRef) {
+    Entity last = v.back();
+    v[pos] = last;
+    m_slots[last.index()].*backRef = pos;
+    v.pop_back();
+}
+
+
+void EntityManager::releaseSlot(uint32_t index) {
+    std::apply([index](auto&... pool) { (pool.remove(index), ...); }, m_pools);
+
+    // bump the generation so handles to the old entity read as invalid
+    auto& slot = m_slots[index];
+    slot.generation = (slot.generation + 1) & Entity::GENERATION_MASK;
+    slot.active = false;
+    slot.alive = false;
+    m_freeSlots.push_back(index);
 }
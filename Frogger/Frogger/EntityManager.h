@@ -6,38 +6,267 @@
 #define BREAKOUT_ENTITYMANAGER_H
 
 
-#include <map>
 #include <vector>
 #include <string>
+#include <span>
+#include <tuple>
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
 #include <memory>
+#include <mutex>
 
-//forward declare
-class Entity;
+#include "Components.h"
+#include "ComponentPool.h"
+#include "Entity.h"
+#include "CommandBuffer.h"
+#include "Prefab.h"
+#include "Tags.h"
 
-using sPtrEntt = std::shared_ptr<Entity>;
-using EntityVec = std::vector<std::shared_ptr<Entity>>;
-using EntityMap = std::map <std::string, EntityVec>;
+
+using EntityVec = std::vector<Entity>;
+using EntitySpan = std::span<const Entity>;     // borrowed, valid until the next EntityManager::update()
+using EntityBuckets = std::vector<EntityVec>;       // indexed by TagId
+
+
+// one ComponentPool per type in ComponentTuple
+template<typename Tuple> struct PoolTuple;
+template<typename... Ts> struct PoolTuple<std::tuple<Ts...>> {
+    using type = std::tuple<ComponentPool<Ts>...>;
+};
+using ComponentPools = PoolTuple<ComponentTuple>::type;
+
+
+template<typename... Ts> class View;
+class CommandBuffer;
 
 
 class EntityManager
 {
 private:
-    EntityVec	    m_entities;
-    EntityMap	    m_entityMap;
-    size_t		    m_totalEntities{ 0 };
-    EntityVec	    m_EntitiesToAdd;
+    friend class Entity;
+
+    struct Slot {
+        size_t              id{ 0 };
+        TagId               tag{ Tag::Default };
+        uint32_t            generation{ 0 };
+        bool                active{ false };    // cleared by Entity::destroy()
+        bool                alive{ false };     // set once update() has added the entity
+        uint32_t            entityPos{ 0 };     // index in m_entities
+        uint32_t            bucketPos{ 0 };     // index in m_entityBuckets[tag]
+    };
+
+    EntityVec	            m_entities;
+    EntityBuckets           m_entityBuckets;
+    size_t		            m_totalEntities{ 0 };
+    EntityVec	            m_EntitiesToAdd;
+    std::vector<uint32_t>   m_dead;             // slots destroyed since the last update
+    float                   m_compactionRatio{ 0.f };
 
-    void		    removeDeadEntities(EntityVec& v);
+    ComponentPools          m_pools;
+    std::vector<Slot>       m_slots;
+    std::vector<uint32_t>   m_freeSlots;
+
+    std::vector<std::unique_ptr<CommandBuffer>> m_commandBuffers;     // indexed by stream
+    std::mutex              m_commandMutex;
+
+    std::vector<Prefab>     m_prefabs;          // indexed by PrefabId
+
+    void                    removeEntity(uint32_t index);
+    void                    swapAndPop(EntityVec& v, uint32_t pos, uint32_t Slot::* backRef);
+    void                    releaseSlot(uint32_t index);
 
 public:
     EntityManager();
 
-    std::shared_ptr<Entity>         addEntity(const std::string& tag);
-    EntityVec& getEntities();
-    EntityVec& getEntities(const std::string& tag);
+    EntityManager(const EntityManager&) = delete;
+    EntityManager& operator=(const EntityManager&) = delete;
+
+    Entity                          addEntity(TagId tag);
+    Entity                          addEntity(const std::string& tag);     // interns the tag, prefer the TagId overload
+    EntitySpan                      getEntities();
+    EntitySpan                      getEntities(TagId tag);
 
     void                            update();
+
+    // Buffer for one stream of deferred changes, played back at the start
+    // of the next update() in stream order. Give each thread or job its own
+    // stream, the returned buffer is not itself thread safe.
+    CommandBuffer&                  commands(size_t stream = 0);
+
+    PrefabId                        definePrefab(Prefab prefab);
+    const Prefab&                   getPrefab(PrefabId id) const;
+
+    // Spawns one entity per instance, each a copy of the prefab's components
+    // with the instance's position and velocity. The pools are sized once for
+    // the whole batch. The returned span is valid until the next addEntity().
+    EntitySpan                      instantiate(const Prefab& prefab, std::span<const PrefabInstance> instances);
+    Entity                          instantiate(const Prefab& prefab, const PrefabInstance& instance);
+    // count plain copies, no CTransform unless the prefab has one
+    EntitySpan                      instantiate(const Prefab& prefab, size_t count);
+    void                            compact();
+
+    // Room for n entities in the slot table, the entity lists and the
+    // pools' sparse arrays; the pools double their own dense arrays and
+    // update() each tag bucket.
+    // addEntity() doubles it whenever the slot table is full, so a world
+    // that is not growing past its peak does not allocate.
+    void                            reserve(size_t n);
+
+    // compact() after any update that removes at least this fraction of
+    // the live entities, 0 turns it off
+    void                            setCompactionRatio(float ratio);
+
+
+    template<typename T>
+    inline ComponentPool<T>& getPool() {
+        return std::get<ComponentPool<T>>(m_pools);
+    }
+
+
+    template<typename T>
+    inline const ComponentPool<T>& getPool() const {
+        return std::get<ComponentPool<T>>(m_pools);
+    }
+
+
+    // true once the entity in the slot has been added and until it is removed
+    inline bool isAlive(uint32_t index) const {
+        return m_slots[index].alive;
+    }
+
+
+    inline Entity entityAt(uint32_t index) {
+        return Entity(this, index, m_slots[index].generation);
+    }
+
+
+    // all live entities that own every one of Ts...
+    template<typename... Ts>
+    View<Ts...> view();
+
+
+    // bytes reserved by each pool, indexed like ComponentTuple (see COMPONENT_NAMES)
+    void                            componentMemory(std::vector<size_t>& bytes) const;
+
+    // Whole-world state, entity lists are rebuilt from the slot table on
+    // load. Commands recorded but not yet played back are not captured.
+    void                            save(SnapshotWriter& w) const;
+    void                            load(SnapshotReader& r);
 };
 
 
+template<typename... Ts>
+class View {
+private:
+    EntityManager&                  m_manager;
+    const std::vector<uint32_t>*    m_slots{ nullptr };     // slots of the smallest pool, drives the iteration
+    size_t                          m_size{ 0 };
+
+    bool contains(uint32_t slot) const {
+        return m_manager.isAlive(slot) && (m_manager.getPool<Ts>().has(slot) && ...);
+    }
+
+public:
+    explicit View(EntityManager& manager) : m_manager(manager) {
+        auto pick = [this](const auto& pool) {
+            if (m_slots == nullptr || pool.size() < m_slots->size())
+                m_slots = &pool.slots();
+            };
+        (pick(m_manager.getPool<Ts>()), ...);
+
+        // components added while iterating are picked up next frame
+        m_size = m_slots->size();
+    }
+
+
+    class iterator {
+    private:
+        const View*     m_view;
+        size_t          m_idx;
+
+        void skip() {
+            while (m_idx < m_view->end_idx() && !m_view->contains((*m_view->m_slots)[m_idx]))
+                ++m_idx;
+        }
+
+    public:
+        iterator(const View* view, size_t idx) : m_view(view), m_idx(idx) { skip(); }
+
+        Entity operator*() const { return m_view->m_manager.entityAt((*m_view->m_slots)[m_idx]); }
+        iterator& operator++() { ++m_idx; skip(); return *this; }
+        bool operator!=(const iterator& other) const { return m_idx != other.m_idx; }
+        bool operator==(const iterator& other) const { return m_idx == other.m_idx; }
+    };
+
+
+    iterator begin() const { return iterator(this, 0); }
+    iterator end() const { return iterator(this, end_idx()); }
+
+
+    // f(entity, Ts&...) for every match, skips the sparse lookup of the driving pool in user code
+    template<typename F>
+    void each(F&& f) {
+        eachInRange(0, end_idx(), std::forward<F>(f));
+    }
+
+
+    // each() over [first, last) of the driving pool, disjoint ranges can run on different threads
+    template<typename F>
+    void eachInRange(size_t first, size_t last, F&& f) {
+        last = std::min(last, end_idx());
+        for (size_t i{ first }; i < last; ++i) {
+            uint32_t slot = (*m_slots)[i];
+            if (contains(slot))
+                f(m_manager.entityAt(slot), m_manager.getPool<Ts>().get(slot)...);
+        }
+    }
+
+
+    // number of driving pool entries, the range eachInRange() splits
+    size_t extent() const { return end_idx(); }
+
+private:
+    // guards against the driving pool shrinking mid iteration
+    size_t end_idx() const {
+        return std::min(m_size, m_slots->size());
+    }
+};
+
+
+template<typename... Ts>
+inline View<Ts...> EntityManager::view() {
+    return View<Ts...>(*this);
+}
+
+
+// Entity component API, needs the complete EntityManager
+template<typename T>
+inline bool Entity::hasComponent() const {
+    assert(isValid());
+    return m_manager->getPool<T>().has(index());
+}
+
+
+template<typename T, typename... TArgs>
+inline T& Entity::addComponent(TArgs &&... mArgs) const {
+    assert(isValid());
+    return m_manager->getPool<T>().emplace(index(), std::forward<TArgs>(mArgs)...);
+}
+
+
+template<typename T>
+inline bool Entity::removeComponent() const {
+    assert(isValid());
+    return m_manager->getPool<T>().remove(index());
+}
+
+
+template<typename T>
+inline T& Entity::getComponent() const {
+    assert(isValid());
+    return m_manager->getPool<T>().get(index());
+}
+
+
 #endif //BREAKOUT_ENTITYMANAGER_H
@@ -3,18 +3,70 @@
 #include "Scene_Frogger.h"
 #include "Scene_Menu.h"
 #include "Command.h"
+#include "JobSystem.h"
+#include "Profiler.h"
+#include "MemoryTracker.h"
+#include "SoundPlayer.h"
+#include "Tags.h"
+#include <sstream>
+#include <iomanip>
+#include "SoundPlayer.h"
+#include "MusicPlayer.h"
 #include <fstream>
 #include <memory>
 #include <cstdlib>
+#include <thread>
+#include <chrono>
+#include <algorithm>
 
 
-GameEngine::GameEngine(const std::string& path)
+namespace {
+	using Clock = RenderSnapshot::Clock;
+
+	const sf::Time IDLE_TIME_PER_FRAME = sf::seconds(1.f / 30.f);	// how often an idle window looks for news
+	const std::string TRACE_PATH = "trace.json";					// F9 and exit, profiling builds only
+	const sf::Time STATISTICS_REFRESH = sf::seconds(0.25f);			// the text is rebuilt this often
+	const int WARM_UP_FRAMES = 120;									// after a scene change, until pools and buffers have grown
+
+	Clock::duration toDuration(sf::Time t) {
+		return std::chrono::microseconds(t.asMicroseconds());
+	}
+
+	// sleep_until alone can overshoot by a scheduler tick, so the last
+	// millisecond is spent yielding when the deadline matters
+	void sleepUntil(Clock::time_point deadline, bool precise) {
+		const auto coarse = precise ? deadline - std::chrono::milliseconds(1) : deadline;
+		if (Clock::now() < coarse)
+			std::this_thread::sleep_until(coarse);
+		while (precise && Clock::now() < deadline)
+			std::this_thread::yield();
+	}
+}
+
+
+GameEngine::GameEngine(const std::string& path, bool headless)
+	: m_headless(headless)
 {
-	Assets::getInstance().loadFromFile("../config.txt");
+	if (m_headless)
+	{
+		// before anything asks the players for an audio device
+		SoundPlayer::useNullBackend();
+		MusicPlayer::useNullBackend();
+	}
+
+	Assets::getInstance().loadFromFile("../config.txt", m_headless);
 	init(path);
 }
 
 
+GameEngine::~GameEngine()
+{
+	// builds still running capture this
+	for (auto& [name, standby] : m_standby)
+		JobSystem::getInstance().wait(standby.ready);
+}
+
+
 void GameEngine::init(const std::string& path)
 {
 	unsigned int width;
@@ -22,16 +74,21 @@ void GameEngine::init(const std::string& path)
 	loadConfigFromFile(path, width, height);
 
 
+	m_windowSize = sf::Vector2f(static_cast<float>(width), static_cast<float>(height));
+	if (m_headless)
+		return;		// runHeadless() picks the scene
+
 	m_window.create(sf::VideoMode(width, height), "GEX Planes");
+	m_cache.create(width, height);
 
 	m_statisticsText.setFont(Assets::getInstance().getFont("main"));
 	m_statisticsText.setPosition(15.0f, 5.0f);
 	m_statisticsText.setCharacterSize(15);
 
-	changeScene("MENU", std::make_shared<Scene_Menu>(this));
+	pushScene(std::make_shared<Scene_Menu>(this));
 }
 
-void GameEngine::loadConfigFromFile(const std::string& path, unsigned int& width, unsigned int& height) const {
+void GameEngine::loadConfigFromFile(const std::string& path, unsigned int& width, unsigned int& height) {
 	std::ifstream config(path);
 	if (config.fail()) {
 		std::cerr << "Open file " << path << " failed\n";
@@ -44,6 +101,24 @@ void GameEngine::loadConfigFromFile(const std::string& path, unsigned int& width
 		if (token == "Window") {
 			config >> width >> height;
 		}
+		else if (token == "Simulation") {
+			float rate;
+			config >> rate >> m_maxCatchUp;
+			if (rate > 0.f)
+				m_timePerUpdate = sf::seconds(1.f / rate);
+			m_maxCatchUp = std::max(1, m_maxCatchUp);
+		}
+		else if (token == "FrameRate") {
+			float rate;
+			config >> rate;
+			if (rate > 0.f)
+				m_timePerFrame = sf::seconds(1.f / rate);
+		}
+		else if (token == "HitchBudget") {
+			float ms;
+			config >> ms;
+			m_hitches.setBudget(ms);
+		}
 		else if (token[0] == '#') {
 			std::string tmp;
 			std::getline(config, tmp);
@@ -60,6 +135,7 @@ void GameEngine::loadConfigFromFile(const std::string& path, unsigned int& width
 }
 
 
+// main thread, the keys are turned into actions by the simulation thread
 void GameEngine::sUserInput()
 {
 	sf::Event event;
@@ -68,81 +144,411 @@ void GameEngine::sUserInput()
 		if (event.type == sf::Event::Closed)
 			quit();
 
-		if (event.type == sf::Event::KeyPressed || event.type == sf::Event::KeyReleased)
+		if (event.type == sf::Event::Resized || event.type == sf::Event::GainedFocus)
+			m_redraw = true;
+
+		if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::F9)
+			Profiler::getInstance().writeTrace(TRACE_PATH);
+
+		if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::F3)
+		{
+			m_showStatistics = !m_showStatistics;
+			m_redraw = true;
+		}
+
+		if (event.type == sf::Event::KeyPressed || event.type == sf::Event::KeyReleased
+			|| event.type == sf::Event::LostFocus || event.type == sf::Event::GainedFocus)
 		{
-			if (currentScene()->getActionMap().contains(event.key.code))
 			{
-				const std::string actionType = (event.type == sf::Event::KeyPressed) ? "START" : "END";
-				currentScene()->doAction(Command(currentScene()->getActionMap().at(event.key.code), actionType));
+				std::lock_guard<std::mutex> lock(m_inputMutex);
+				m_input.push_back(event);
 			}
+			m_inputReady.notify_one();
 		}
 	}
 }
 
-std::shared_ptr<Scene> GameEngine::currentScene()
+
+// simulation thread
+bool GameEngine::sDispatchInput()
 {
-	return m_sceneMap.at(m_currentScene);
+	// the two buffers trade places, both keep their capacity
+	m_events.clear();
+	{
+		std::lock_guard<std::mutex> lock(m_inputMutex);
+		m_events.swap(m_input);
+	}
+
+	for (const auto& event : m_events)
+	{
+		if (event.type == sf::Event::LostFocus || event.type == sf::Event::GainedFocus)
+		{
+			m_hasFocus = (event.type == sf::Event::GainedFocus);
+			continue;
+		}
+
+		const auto& actions = currentScene()->getActionMap();
+		auto found = actions.find(event.key.code);
+		if (found != actions.end())
+		{
+			const std::string actionType = (event.type == sf::Event::KeyPressed) ? "START" : "END";
+			currentScene()->doAction(Command(found->second, actionType));
+		}
+	}
+	return !m_events.empty();
 }
 
-void GameEngine::changeScene(const std::string& sceneName, std::shared_ptr<Scene> scene, bool endCurrentScene)
+
+// scene changes allocate by design, steady state starts over after them
+void GameEngine::pushScene(std::shared_ptr<Scene> scene)
 {
+	AllocationScope transition;
+	m_warmUp = WARM_UP_FRAMES;
+	m_scenes.push_back(std::move(scene));
+	m_currentScene = m_scenes.back().get();
+	m_currentScene->onEnter();
+}
 
 
-	if (endCurrentScene) {
-		// remove scene from map
-		m_sceneMap.erase(m_currentScene);
-	}
+// the popped scene lives on as long as someone holds it, e.g. parkScene()
+void GameEngine::popScene()
+{
+	AllocationScope transition;
+	m_warmUp = WARM_UP_FRAMES;
+	m_scenes.pop_back();
+	m_currentScene = m_scenes.empty() ? nullptr : m_scenes.back().get();
+	if (m_currentScene)
+		m_currentScene->onEnter();
+}
+
+
+void GameEngine::preloadScene(const std::string& name, SceneFactory build)
+{
+	if (m_standby.contains(name))
+		return;
+
+	auto slot = std::make_shared<std::shared_ptr<Scene>>();
+	auto ready = JobSystem::getInstance().submit([slot, build = std::move(build)] { *slot = build(); });
+	m_standby[name] = StandbyScene{ ready, slot };
+}
 
-	if (!m_sceneMap.contains(sceneName)) {
-		// if scene not in map alrady put new one in
-		// otherwise use existing scene arleady in map
-		m_sceneMap[sceneName] = scene;
-	}
 
-	m_currentScene = sceneName;
+std::shared_ptr<Scene> GameEngine::takeScene(const std::string& name)
+{
+	auto found = m_standby.find(name);
+	if (found == m_standby.end())
+		return nullptr;
+
+	JobSystem::getInstance().wait(found->second.ready);
+	auto scene = std::move(*found->second.scene);
+	m_standby.erase(found);
+	return scene;
+}
+
+
+void GameEngine::parkScene(const std::string& name, std::shared_ptr<Scene> scene)
+{
+	// a build still running for the name captures this, it must not be dropped unwaited
+	auto found = m_standby.find(name);
+	if (found != m_standby.end())
+		JobSystem::getInstance().wait(found->second.ready);
+	m_standby[name] = StandbyScene{ JobSystem::Handle(), std::make_shared<std::shared_ptr<Scene>>(std::move(scene)) };
 }
 
 
+// the main thread closes the window once the simulation has stopped
 void GameEngine::quit()
 {
-	m_window.close();
+	{
+		std::lock_guard<std::mutex> lock(m_inputMutex);
+		m_running = false;
+	}
+	m_inputReady.notify_one();
 }
 
 
+// The simulation steps the world on its own thread and records a frame
+// after each round of updates. The main thread polls the window and draws
+// the newest recorded frame, so a slow draw no longer eats into the
+// simulation budget and frame N+1 is simulated while frame N is drawn.
+//
+// Drawing is paced to FrameRate. While the scene is idle (paused, menu,
+// no focus) the frame is drawn once into m_cache and the window is only
+// refreshed from it when something changed.
 void GameEngine::run()
 {
-	const sf::Time SPF = sf::seconds(1.0f / 60.f);  // seconds per frame for 60 fps 
+	JobSystem::getInstance();						// created on the main thread
+	PROFILE_THREAD("main");
+	std::thread simulation([this] { simulate(); });
+
+	auto deadline = Clock::now();
+	while (isRunning())
+	{
+		sUserInput();								// get user input
+		JobSystem::getInstance().pumpMain();		// jobs that need the main thread
+
+		const bool fresh = m_frames.acquire();
+		const auto& frame = m_frames.front();
+
+		sf::Clock renderClock;
+		size_t drawCalls{ 0 };
+		bool shown{ false };
+		if (frame.idle)
+		{
+			if (fresh)
+			{
+				PROFILE_ZONE("draw");
+				draw(m_cache, frame);
+				m_cache.display();
+			}
+			if (fresh || m_redraw)
+			{
+				m_window.setView(m_window.getDefaultView());
+				m_window.draw(sf::Sprite(m_cache.getTexture()));
+				drawStatistics();
+				m_window.display();
+				m_redraw = false;
+				drawCalls = 1;
+				shown = true;
+			}
+		}
+		else if (frame.step > sf::Time::Zero)		// nothing recorded yet otherwise
+		{
+			PROFILE_ZONE("draw");
+			drawCalls = draw(m_window, frame, frame.alphaAt(Clock::now()));	// render world, blended towards the next update
+
+			// draw stats
+			drawStatistics();
+
+			// display
+			window().display();
+			shown = true;
+		}
+
+		if (shown)
+		{
+			const sf::Time frameTime = m_frameClock.restart();
+			const float renderMs = renderClock.getElapsedTime().asSeconds() * 1000.f;
+			updateStatistics(frameTime, renderMs, drawCalls, frame);
+			m_hitches.add(frameTime, renderMs, drawCalls, frame, fresh);
+		}
+
+		// a late frame starts a new schedule instead of rushing the next ones
+		deadline += toDuration(frame.idle ? IDLE_TIME_PER_FRAME : m_timePerFrame);
+		deadline = std::max(deadline, Clock::now());
+		sleepUntil(deadline, !frame.idle);
+	}
+
+	m_running = false;
+	simulation.join();
+	m_window.close();
+	Profiler::getInstance().writeTrace(TRACE_PATH);
+}
+
+
+void GameEngine::simulate()
+{
+	const sf::Time SPF = m_timePerUpdate;
+	PROFILE_THREAD("simulation");
 
 	sf::Clock clock;
 	sf::Time timeSinceLastUpdate = sf::Time::Zero;
+	bool idle{ false };
 
-	while (isRunning())
+	while (m_running)
 	{
-		sUserInput();								// get user input
+		const bool input = sDispatchInput();		// get user input
+
+		sf::Clock updateClock;
+		if (!m_hasFocus || currentScene()->isIdle())
+		{
+			// one update for the input that just came in, or to record the
+			// frame on going idle, then sleep until the next. waitForInput()
+			// also returns on its timeout, which is no reason to step.
+			if (input || !idle)
+			{
+				currentScene()->simulate(1);
+				recordFrame(sf::Time::Zero, true, updateClock.getElapsedTime());
+			}
+			idle = true;
+			waitForInput();
+
+			clock.restart();
+			timeSinceLastUpdate = sf::Time::Zero;
+			continue;
+		}
+		idle = false;
 
 		timeSinceLastUpdate += clock.restart();
-		while (timeSinceLastUpdate > SPF)
+		updateClock.restart();
+		int steps{ 0 };
 		{
-			currentScene()->update(SPF);			// update world
-			timeSinceLastUpdate -= SPF;
+			// once warmed up the updates and sRender must not allocate,
+			// checked in ASSERT_NO_ALLOCATIONS builds
+			NoAllocationScope steady(m_warmUp == 0);
+			while (timeSinceLastUpdate > SPF && steps < m_maxCatchUp)
+			{
+				currentScene()->simulate(static_cast<int>(m_simulationSpeed));	// update world
+				timeSinceLastUpdate -= SPF;
+				++steps;
+			}
+
+			// after a stall drop what is left instead of spiralling
+			if (timeSinceLastUpdate > SPF)
+				timeSinceLastUpdate = sf::Time::Zero;
+
+			if (steps > 0)
+				recordFrame(timeSinceLastUpdate, false, updateClock.getElapsedTime());	// record world
 		}
+		if (steps > 0 && m_warmUp > 0)
+			--m_warmUp;
 
-		currentScene()->sRender();					// render world
+		// nothing to do until the next step is due
+		std::this_thread::sleep_for(std::chrono::microseconds((SPF - timeSinceLastUpdate).asMicroseconds()));
+	}
+}
 
-		// draw stats
+void GameEngine::recordFrame(sf::Time sinceLastUpdate, bool idle, sf::Time updateTime)
+{
+	sf::Clock recordClock;
+	auto& frame = m_frames.back();
+	frame.clear();
+	frame.step = m_timePerUpdate;
+	frame.time = Clock::now() - toDuration(sinceLastUpdate);
+	frame.idle = idle;
 
-		// display
-		window().display();
+	{
+		PROFILE_ZONE("sRender");
+		currentScene()->sRender(frame);
 	}
+	const float renderMs = recordClock.getElapsedTime().asSeconds() * 1000.f;
+
+	auto& stats = frame.stats;
+	currentScene()->takeTimings(stats.zones);
+	stats.zones.push_back(ZoneTime{ "sRender", renderMs });
+
+	const uint64_t allocations = MemoryTracker::threadAllocations();
+	stats.allocations = allocations - m_simAllocations;
+	m_simAllocations = allocations;
+
+	stats.collisionTests = PerfCounters::take(PerfCounters::CollisionTests);
+	stats.soundVoices = SoundPlayer::getInstance().voices();
+	currentScene()->countEntities(stats.entitiesPerTag);
+	currentScene()->componentMemory(stats.componentBytes);
+	stats.simMs = (updateTime + recordClock.getElapsedTime()).asSeconds() * 1000.f;
+	m_frames.publish();
+}
+
+
+// main thread, once per displayed frame
+void GameEngine::updateStatistics(sf::Time frameTime, float renderMs, size_t drawCalls, const RenderSnapshot& frame)
+{
+	m_frameTimes.add(frameTime.asSeconds() * 1000.f);
+	m_statisticsUpdateTime += frameTime;
+	m_statisticsNumFrames += 1;
+	m_renderMs += renderMs;
+	m_drawCalls += drawCalls;
+
+	if (m_statisticsUpdateTime < STATISTICS_REFRESH)
+		return;
+
+	const float seconds = m_statisticsUpdateTime.asSeconds();
+	const uint64_t allocations = MemoryTracker::allocations();
+	const auto& stats = frame.stats;
+
+	std::ostringstream text;
+	text << std::fixed << std::setprecision(1);
+	text << "FPS " << static_cast<int>(m_statisticsNumFrames / seconds)
+		<< "   frame p50 " << m_frameTimes.percentile(0.5f)
+		<< "  p95 " << m_frameTimes.percentile(0.95f)
+		<< "  p99 " << m_frameTimes.percentile(0.99f) << " ms\n";
+	text << "sim " << stats.simMs << " ms   render " << m_renderMs / m_statisticsNumFrames << " ms\n";
+	text << "draw calls " << m_drawCalls / m_statisticsNumFrames
+		<< "   collision tests " << stats.collisionTests << "\n";
+	text << "sounds " << stats.soundVoices
+		<< "   allocations " << (allocations - m_allocations) / m_statisticsNumFrames << " / frame\n";
+
+	uint32_t total{ 0 };
+	for (auto count : stats.entitiesPerTag)
+		total += count;
+	text << "entities " << total;
+	for (size_t tag{ 0 }; tag < stats.entitiesPerTag.size(); ++tag)
+		if (stats.entitiesPerTag[tag] > 0)
+			text << "\n  " << TagRegistry::getInstance().getName(static_cast<TagId>(tag)) << " " << stats.entitiesPerTag[tag];
+
+	size_t bytes{ 0 };
+	for (auto b : stats.componentBytes)
+		bytes += b;
+	text << "\ncomponents " << bytes / 1024.f << " KB";
+	for (size_t c{ 0 }; c < stats.componentBytes.size(); ++c)
+		text << "\n  " << COMPONENT_NAMES[c] << " " << stats.componentBytes[c] / 1024.f << " KB";
+
+	m_statisticsText.setString(text.str());
+	m_statisticsUpdateTime = sf::Time::Zero;
+	m_statisticsNumFrames = 0;
+	m_renderMs = 0.f;
+	m_drawCalls = 0;
+	m_allocations = allocations;
+}
+
+
+void GameEngine::drawStatistics()
+{
+	if (!m_showStatistics)
+		return;
+
+	m_window.setView(m_window.getDefaultView());
+	m_window.draw(m_statisticsText);
+}
+
+
+// simulation thread, gives up now and then so a lost notify costs little
+void GameEngine::waitForInput()
+{
+	std::unique_lock<std::mutex> lock(m_inputMutex);
+	m_inputReady.wait_for(lock, std::chrono::milliseconds(250),
+		[this] { return !m_input.empty() || !m_running; });
 }
 
-void GameEngine::quitLevel() {
-	changeScene("MENU", nullptr, true);
+
+// No window and no audio: runs the level for the given number of fixed
+// updates as fast as the CPU allows and reports the rate.
+void GameEngine::runHeadless(int ticks, const std::string& levelPath)
+{
+	auto scene = std::make_shared<Scene_Frogger>(this, levelPath);
+	pushScene(scene);
+	scene->simulate(WARM_UP_FRAMES);
+
+	// timed the way the window's steady state runs, under its allocation check
+	double rate;
+	{
+		NoAllocationScope steady;
+		rate = scene->simulate(ticks);
+	}
+	std::cout << "Simulated " << ticks << " ticks at " << static_cast<long long>(rate) << " ticks/s";
+	if (currentScene() != scene.get())
+		std::cout << " (the level ended early)";
+	std::cout << "\n";
+
+	Profiler::getInstance().writeTrace(TRACE_PATH);
 }
 
-void GameEngine::backLevel() {
-	changeScene("MENU", nullptr, false);
+// Both return to the scene below and keep the level for the next play,
+// so playing again neither reparses the level nor reallocates its storage.
+// The level is parked before the pop, the menu preloads its selection in
+// onEnter() and skips a name that is already on standby.
+void GameEngine::quitLevel(const std::string& name) {
+	AllocationScope transition;
+	auto level = m_scenes.back();
+	level->reset();
+	parkScene(name, std::move(level));
+	popScene();
+}
 
+void GameEngine::backLevel(const std::string& name) {
+	AllocationScope transition;
+	parkScene(name, m_scenes.back());
+	popScene();
 }
 
 
@@ -151,8 +557,19 @@ sf::RenderWindow& GameEngine::window()
 	return m_window;
 }
 
+// cached, the window belongs to the main thread
 sf::Vector2f GameEngine::windowSize() const {
-	return sf::Vector2f{ m_window.getSize() };
+	return m_windowSize;
+}
+
+
+sf::Time GameEngine::timePerUpdate() const {
+	return m_timePerUpdate;
+}
+
+// updates per fixed step, fast forward in game
+void GameEngine::setSimulationSpeed(size_t speed) {
+	m_simulationSpeed = std::max<size_t>(1, speed);
 }
 
 
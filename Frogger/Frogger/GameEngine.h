@@ -2,50 +2,110 @@
 
 
 #include "Assets.h"
+#include "RenderSnapshot.h"
+#include "TripleBuffer.h"
+#include "JobSystem.h"
+#include "PerfStats.h"
+#include "HitchRecorder.h"
 
 #include <memory>
 #include <map>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
 
 class Scene;
 
-using SceneMap = std::map<std::string, std::shared_ptr<Scene>>;
+using SceneStack = std::vector<std::shared_ptr<Scene>>;
+using SceneFactory = std::function<std::shared_ptr<Scene>()>;
 
 class GameEngine
 {
 
 public:
 	sf::RenderWindow	        m_window;
-	std::string			        m_currentScene;
-	SceneMap			        m_sceneMap;
-	size_t				        m_simulationSpeed{ 1 };
-	bool				        m_running{ true };
-
-	void						loadConfigFromFile(const std::string& path, unsigned int& width, unsigned int& height) const;
+	SceneStack			        m_scenes;			// top is current, the rest are suspended
+	Scene*						m_currentScene{ nullptr };	// m_scenes.back(), simulation thread
+
+	// scenes built ahead of time or parked for the next play, by name
+	struct StandbyScene {
+		JobSystem::Handle					ready;
+		std::shared_ptr<std::shared_ptr<Scene>>	scene;	// filled in by the job
+	};
+	std::map<std::string, StandbyScene>	m_standby;
+	size_t				        m_simulationSpeed{ 1 };		// fixed updates per step
+	sf::Time					m_timePerUpdate{ sf::seconds(1.f / 60.f) };	// Simulation rate in the config
+	int							m_maxCatchUp{ 5 };			// fixed steps per frame before falling behind
+	sf::Time					m_timePerFrame{ sf::seconds(1.f / 144.f) };	// FrameRate in the config
+	bool						m_headless{ false };		// no window, no audio
+	std::atomic<bool>	        m_running{ true };
+	sf::Vector2f				m_windowSize;
+
+	// the main thread owns the window, the simulation thread owns the scenes
+	std::mutex					m_inputMutex;
+	std::vector<sf::Event>		m_input;		// key and focus events for the simulation thread
+	std::vector<sf::Event>		m_events;		// the ones being handled, simulation thread
+	std::condition_variable		m_inputReady;	// wakes an idle simulation
+	TripleBuffer<RenderSnapshot> m_frames;		// newest recorded frame for the main thread
+
+	sf::RenderTexture			m_cache;		// last idle frame, main thread
+	bool						m_redraw{ false };	// the window needs the cached frame again
+	bool						m_hasFocus{ true };	// simulation thread
+	int							m_warmUp{ 0 };		// recorded frames until the scene is steady, simulation thread
+
+	void						loadConfigFromFile(const std::string& path, unsigned int& width, unsigned int& height);
 	void						init(const std::string& path);
 	void						sUserInput();
-	std::shared_ptr<Scene>		currentScene();
+	bool						sDispatchInput();	// true when there were events
+	void						simulate();
+	void						waitForInput();
+	void						recordFrame(sf::Time sinceLastUpdate, bool idle, sf::Time updateTime);
 
-	// stats
+	// stats, F3 shows them; main thread
+	bool						m_showStatistics{ false };
 	sf::Text					m_statisticsText;
 	sf::Time					m_statisticsUpdateTime{ sf::Time::Zero };
 	unsigned int				m_statisticsNumFrames{ 0 };
+	FrameTimes					m_frameTimes;
+	sf::Clock					m_frameClock;
+	float						m_renderMs{ 0.f };			// summed since the text was last updated
+	size_t						m_drawCalls{ 0 };
+	uint64_t					m_allocations{ 0 };			// MemoryTracker count when the text was last updated
+	HitchRecorder				m_hitches;					// main thread
+	uint64_t					m_simAllocations{ 0 };		// MemoryTracker thread count at the last recorded frame
+
+	void						updateStatistics(sf::Time frameTime, float renderMs, size_t drawCalls, const RenderSnapshot& frame);
+	void						drawStatistics();
 
 public:
 
-	GameEngine(const std::string& path);
+	GameEngine(const std::string& path, bool headless = false);
+	~GameEngine();
+
+	Scene*				currentScene() const { return m_currentScene; }
+	void				pushScene(std::shared_ptr<Scene> scene);
+	void				popScene();
 
-	void changeScene(const std::string& sceneName,
-		std::shared_ptr<Scene> scene,
-		bool endCurrentScene = false);
+	// Builds the scene on a worker so it is ready by the time it is taken.
+	// Does nothing if a scene is already parked or being built under name.
+	void				preloadScene(const std::string& name, SceneFactory build);
+	// the parked or preloaded scene, waits for a build still running; null if none
+	std::shared_ptr<Scene>	takeScene(const std::string& name);
+	void				parkScene(const std::string& name, std::shared_ptr<Scene> scene);
 
 	void				quit();
 	void				run();
-	void				quitLevel();
-	void				backLevel();
+	void				runHeadless(int ticks, const std::string& levelPath);
+	void				quitLevel(const std::string& name);		// parks the level reset for the next play
+	void				backLevel(const std::string& name);		// parks the level as it is
 
 	sf::RenderWindow& window();
 
 	sf::Vector2f		windowSize() const;
+	sf::Time			timePerUpdate() const;
+	void				setSimulationSpeed(size_t speed);
 	bool				isRunning();
 
 };
@@ -0,0 +1,154 @@
+#include "HitchRecorder.h"
+#include "MemoryTracker.h"
+#include "Profiler.h"
+#include "Tags.h"
+#include "json.hpp"
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+
+namespace {
+    // hitch-20240131-235959Z, from the calendar so no C time functions are needed
+    std::string dumpName() {
+        using namespace std::chrono;
+        const auto now = floor<seconds>(system_clock::now());
+        const auto day = floor<days>(now);
+        const year_month_day date{ day };
+        const hh_mm_ss time{ now - day };
+
+        std::ostringstream name;
+        name << "hitch-" << std::setfill('0')
+            << std::setw(4) << static_cast<int>(date.year())
+            << std::setw(2) << static_cast<unsigned>(date.month())
+            << std::setw(2) << static_cast<unsigned>(date.day()) << "-"
+            << std::setw(2) << time.hours().count()
+            << std::setw(2) << time.minutes().count()
+            << std::setw(2) << time.seconds().count() << "Z";
+        return name.str();
+    }
+
+
+    void write(const std::string& name, float budgetMs, const std::vector<HitchRecorder::Frame>& frames,
+        const std::vector<std::string>& tags) {
+        using json = nlohmann::json;
+        const auto end = frames.back().time;
+
+        json out = json::array();
+        for (const auto& f : frames) {
+            json frame{
+                { "atMs", std::chrono::duration<double, std::milli>(f.time - end).count() },
+                { "frameMs", f.frameMs },
+                { "renderMs", f.renderMs },
+                { "drawCalls", f.drawCalls },
+                { "allocations", f.allocations } };
+
+            if (f.fresh) {
+                json zones = json::object();
+                for (const auto& zone : f.zones)
+                    zones[zone.name] = zone.ms;
+                json entities = json::object();
+                for (size_t tag{ 0 }; tag < f.entitiesPerTag.size() && tag < tags.size(); ++tag)
+                    if (f.entitiesPerTag[tag] > 0)
+                        entities[tags[tag]] = f.entitiesPerTag[tag];
+
+                frame["simulation"] = {
+                    { "ms", f.simMs },
+                    { "allocations", f.simAllocations },
+                    { "collisionTests", f.collisionTests },
+                    { "zones", zones },
+                    { "entities", entities } };
+            }
+            out.push_back(frame);
+        }
+
+        const std::string path = name + ".json";
+        std::ofstream file(path);
+        if (file.fail()) {
+            std::cerr << "Open file " << path << " failed\n";
+            return;
+        }
+        file << json{ { "budgetMs", budgetMs }, { "frames", out } };
+        std::cout << "Frame over budget, wrote " << path << std::endl;
+
+        Profiler::getInstance().writeTrace(name + "-trace.json");
+    }
+}
+
+
+HitchRecorder::HitchRecorder() : m_ring(HISTORY) {
+}
+
+
+HitchRecorder::~HitchRecorder() {
+    JobSystem::getInstance().wait(m_writing);
+}
+
+
+void HitchRecorder::add(sf::Time frameTime, float renderMs, size_t drawCalls, const RenderSnapshot& frame, bool fresh) {
+    const uint64_t allocations = MemoryTracker::allocations();
+
+    // an idle frame waits for input by design, and the first frame after
+    // it counts the wait
+    if (frame.idle) {
+        m_resuming = true;
+        m_allocations = allocations;
+        return;
+    }
+
+    const auto now = Clock::now();
+    auto& f = m_ring[m_count++ % HISTORY];
+    f.time = now;
+    f.frameMs = frameTime.asSeconds() * 1000.f;
+    f.renderMs = renderMs;
+    f.drawCalls = drawCalls;
+    f.allocations = allocations - m_allocations;
+    m_allocations = allocations;
+
+    const auto& stats = frame.stats;
+    f.fresh = fresh;
+    f.simMs = fresh ? stats.simMs : 0.f;
+    f.simAllocations = fresh ? stats.allocations : 0;
+    f.collisionTests = fresh ? stats.collisionTests : 0;
+    f.zones.clear();
+    f.entitiesPerTag.clear();
+    if (fresh) {
+        f.zones.assign(stats.zones.begin(), stats.zones.end());
+        f.entitiesPerTag.assign(stats.entitiesPerTag.begin(), stats.entitiesPerTag.end());
+    }
+
+    const bool resuming = m_resuming;
+    m_resuming = false;
+    if (m_budgetMs <= 0.f || resuming)
+        return;
+
+    // one file per stretch of trouble, and never two writes at a time
+    const bool over = f.frameMs > m_budgetMs || f.simMs > m_budgetMs;
+    if (over && now - m_lastDump > WINDOW && m_writing.done())
+        dump(now);
+}
+
+
+// the copy is the only work on the main thread
+void HitchRecorder::dump(Clock::time_point now) {
+    m_lastDump = now;
+
+    std::vector<Frame> frames;
+    const uint64_t first = m_count > HISTORY ? m_count - HISTORY : 0;
+    for (uint64_t i{ first }; i < m_count; ++i) {
+        const auto& f = m_ring[i % HISTORY];
+        if (now - f.time <= WINDOW)
+            frames.push_back(f);
+    }
+
+    std::vector<std::string> tags;
+    auto& registry = TagRegistry::getInstance();
+    for (size_t tag{ 0 }; tag < registry.size(); ++tag)
+        tags.push_back(registry.getName(static_cast<TagId>(tag)));
+
+    m_writing = JobSystem::getInstance().submit(
+        [name = dumpName(), budget = m_budgetMs, frames = std::move(frames), tags = std::move(tags)] {
+            write(name, budget, frames, tags);
+        });
+}
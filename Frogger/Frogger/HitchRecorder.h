@@ -0,0 +1,71 @@
+#ifndef BREAKOUT_HITCHRECORDER_H
+#define BREAKOUT_HITCHRECORDER_H
+
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <SFML/System/Time.hpp>
+
+#include "RenderSnapshot.h"
+#include "JobSystem.h"
+
+
+// Always on, unlike the Profiler. Keeps the last few seconds of per-frame
+// numbers in a ring and, when a frame goes over budget, writes them to
+// hitch-<UTC time>.json, so a stutter nobody can reproduce still leaves
+// a record. A frame costs a copy into the ring, the file is written on a
+// worker. Profiling builds write the Profiler trace next to it.
+class HitchRecorder {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr size_t HISTORY{ 1024 };                   // frames kept
+    static constexpr std::chrono::seconds WINDOW{ 3 };          // how far back a dump goes
+
+    struct Frame {
+        Clock::time_point       time;
+        float                   frameMs{ 0.f };
+        float                   renderMs{ 0.f };
+        size_t                  drawCalls{ 0 };
+        uint64_t                allocations{ 0 };       // every thread, since the previous frame
+
+        // the simulation frame shown, only set when it is a new one
+        bool                    fresh{ false };
+        float                   simMs{ 0.f };
+        uint64_t                simAllocations{ 0 };
+        uint64_t                collisionTests{ 0 };
+        std::vector<ZoneTime>   zones;
+        std::vector<uint32_t>   entitiesPerTag;
+    };
+
+private:
+    std::vector<Frame>          m_ring;
+    uint64_t                    m_count{ 0 };           // frames ever added
+    float                       m_budgetMs{ 20.f };
+    uint64_t                    m_allocations{ 0 };     // MemoryTracker count at the last frame
+    bool                        m_resuming{ true };     // the next frame time includes a pause
+    Clock::time_point           m_lastDump;
+    JobSystem::Handle           m_writing;
+
+    void                        dump(Clock::time_point now);
+
+public:
+    HitchRecorder();
+    ~HitchRecorder();
+
+    HitchRecorder(const HitchRecorder&) = delete;
+    HitchRecorder& operator=(const HitchRecorder&) = delete;
+
+    // 0 turns it off
+    void                        setBudget(float ms) { m_budgetMs = ms; }
+
+    // main thread, once per displayed frame; fresh if the snapshot was not shown before
+    void                        add(sf::Time frameTime, float renderMs, size_t drawCalls,
+                                    const RenderSnapshot& frame, bool fresh);
+};
+
+
+#endif //BREAKOUT_HITCHRECORDER_H
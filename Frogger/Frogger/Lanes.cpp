@@ -0,0 +1,133 @@
+#include "Lanes.h"
+#include "PerfStats.h"
+#include "Physics.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+
+namespace {
+    double seconds(sf::Time t) {
+        return static_cast<double>(t.asMicroseconds()) * 1e-6;
+    }
+
+    // v mod period in [0, period)
+    double wrap(double v, double period) {
+        return v - period * std::floor(v / period);
+    }
+}
+
+
+void Lanes::clear() {
+    m_lanes.clear();
+    m_obstacles.clear();
+}
+
+
+void Lanes::add(TagId tag, std::span<const Entity> entities, sf::Vector2f position, float spacing,
+    float velocity, sf::Vector2f halfSize, float width, float margin) {
+    Lane lane;
+    lane.tag = tag;
+    lane.y = position.y;
+    lane.halfSize = halfSize;
+    lane.velocity = velocity;
+    lane.left = -halfSize.x - margin;
+    lane.period = width + 2.f * (halfSize.x + margin);
+    lane.first = static_cast<uint32_t>(m_obstacles.size());
+    lane.count = static_cast<uint32_t>(entities.size());
+
+    for (size_t i{ 0 }; i < entities.size(); ++i)
+        m_obstacles.push_back(Obstacle{ entities[i], wrap(position.x + i * spacing - lane.left, lane.period) });
+
+    auto at = std::upper_bound(m_lanes.begin(), m_lanes.end(), lane.y,
+        [](float y, const Lane& other) { return y < other.y; });
+    m_lanes.insert(at, lane);
+}
+
+
+std::span<const Lanes::Obstacle> Lanes::obstacles(const Lane& lane) const {
+    return std::span<const Obstacle>(m_obstacles).subspan(lane.first, lane.count);
+}
+
+
+float Lanes::x(const Lane& lane, const Obstacle& obstacle, sf::Time t) const {
+    return lane.left + static_cast<float>(wrap(obstacle.phase + lane.velocity * seconds(t), lane.period));
+}
+
+
+const Lanes::Lane* Lanes::at(float y, float halfHeight) const {
+    // the first lane whose bottom is below the top of the box
+    auto it = std::partition_point(m_lanes.begin(), m_lanes.end(),
+        [&](const Lane& lane) { return lane.y + lane.halfSize.y <= y - halfHeight; });
+    if (it == m_lanes.end() || it->y - it->halfSize.y >= y + halfHeight)
+        return nullptr;
+    return &*it;
+}
+
+
+const Lanes::Obstacle* Lanes::overlap(const Lane& lane, float x, float halfWidth, sf::Time t) const {
+    PerfCounters::add(PerfCounters::CollisionTests, lane.count);
+    for (const auto& obstacle : obstacles(lane)) {
+        if (std::abs(this->x(lane, obstacle, t) - x) < lane.halfSize.x + halfWidth)
+            return &obstacle;
+    }
+    return nullptr;
+}
+
+
+std::optional<float> Lanes::sweep(const Lane& lane, sf::Vector2f center, sf::Vector2f halfSize, sf::Time from, sf::Time to) const {
+    const double right = lane.left + lane.period;
+    const double total = std::abs(lane.velocity * (seconds(to) - seconds(from)));
+    const double direction = lane.velocity < 0.f ? -1. : 1.;
+
+    std::optional<float> first;
+    for (const auto& obstacle : obstacles(lane)) {
+        double x0 = lane.left + wrap(obstacle.phase + lane.velocity * seconds(from), lane.period);
+        double done{ 0. };
+        while (true) {
+            const double room = direction > 0. ? right - x0 : x0 - lane.left;
+            const double step = std::min(total - done, room);
+            const double x1 = x0 + direction * step;
+
+            const auto toi = Physics::sweptAABB(
+                sf::Vector2f(static_cast<float>(x0), lane.y), sf::Vector2f(static_cast<float>(x1), lane.y), lane.halfSize,
+                center, center, halfSize);
+            if (toi) {
+                const float fraction = total > 0. ? static_cast<float>((done + *toi * step) / total) : 0.f;
+                first = first ? std::min(*first, fraction) : fraction;
+                break;
+            }
+
+            done += step;
+            if (done >= total)
+                break;
+            x0 = direction > 0. ? lane.left : right;
+        }
+    }
+    return first;
+}
+
+
+sf::Time Lanes::contact(const Lane& lane, float x, float halfWidth, sf::Time t) const {
+    constexpr sf::Int64 NEVER{ std::numeric_limits<sf::Int64>::max() };
+    if (lane.count == 0 || lane.velocity == 0.f)
+        return overlap(lane, x, halfWidth, t) ? t : sf::microseconds(NEVER);
+
+    // distance to travel before the leading edge meets the span, around
+    // the wrap if need be
+    const double reach = lane.halfSize.x + halfWidth;
+    const double now = seconds(t);
+    double distance = lane.period;
+    for (const auto& obstacle : obstacles(lane)) {
+        const double ox = lane.left + wrap(obstacle.phase + lane.velocity * now, lane.period);
+        if (std::abs(ox - x) < reach)
+            return t;
+        const double gap = lane.velocity > 0.f ? (x - reach) - ox : ox - (x + reach);
+        distance = std::min(distance, wrap(gap, lane.period));
+    }
+
+    const double delay = distance / std::abs(lane.velocity) - 1e-3;
+    if (delay <= 0.)
+        return t;
+    return t + sf::microseconds(static_cast<sf::Int64>(delay * 1e6));
+}
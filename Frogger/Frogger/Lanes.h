@@ -0,0 +1,76 @@
+#ifndef BREAKOUT_LANES_H
+#define BREAKOUT_LANES_H
+
+
+#include <SFML/System.hpp>
+#include <vector>
+#include <span>
+#include <cstdint>
+#include <optional>
+
+#include "Entity.h"
+
+
+// Rows of obstacles that cross the screen at one constant speed and wrap
+// around, so where an obstacle is depends on the time alone:
+//      x(t) = left + (phase + velocity * t) mod period
+// Nothing moves them from update to update. Positions are worked out when
+// something draws or tests them, any time costs the same to look up, and
+// when the next obstacle reaches a spot can be predicted.
+class Lanes {
+public:
+    struct Obstacle {
+        Entity              entity;         // animation and state, no CTransform
+        double              phase;          // x - left at time zero, in [0, period)
+    };
+
+    struct Lane {
+        TagId               tag;
+        float               y;
+        sf::Vector2f        halfSize;       // of every obstacle in the lane
+        float               velocity;
+        float               left;           // an obstacle wraps between left and left + period
+        float               period;
+        uint32_t            first;          // the obstacles are m_obstacles[first, first + count)
+        uint32_t            count;
+    };
+
+private:
+    std::vector<Lane>       m_lanes;        // by y
+    std::vector<Obstacle>   m_obstacles;
+
+public:
+    void                    clear();
+
+    // entities[i] starts at x = position.x + i * spacing; they wrap once
+    // they are margin clear of [0, width]
+    void                    add(TagId tag, std::span<const Entity> entities, sf::Vector2f position, float spacing,
+                                float velocity, sf::Vector2f halfSize, float width, float margin);
+
+    std::span<const Lane>   lanes() const { return m_lanes; }
+    std::span<const Obstacle> obstacles(const Lane& lane) const;
+
+    float                   x(const Lane& lane, const Obstacle& obstacle, sf::Time t) const;
+
+    // the lane a box at y with the given half height overlaps, if any;
+    // lanes are further apart than they are high
+    const Lane*             at(float y, float halfHeight) const;
+
+    // the first obstacle of the lane overlapping [x - halfWidth, x + halfWidth]
+    const Obstacle*         overlap(const Lane& lane, float x, float halfWidth, sf::Time t) const;
+
+    // Swept over (from, to]: the fraction of that time at which an obstacle
+    // of the lane first overlaps the box at center, which stands still;
+    // nothing if none does. An obstacle that wraps in between is swept up
+    // to the edge and on from the other one.
+    std::optional<float>    sweep(const Lane& lane, sf::Vector2f center, sf::Vector2f halfSize, sf::Time from, sf::Time to) const;
+
+    // When an obstacle of the lane first touches [x - halfWidth, x + halfWidth],
+    // t if one does already. Rounded a millisecond early, never late; the
+    // largest sf::Time if the lane stands still and nothing touches. The
+    // span must lie inside the wrap range of the lane.
+    sf::Time                contact(const Lane& lane, float x, float halfWidth, sf::Time t) const;
+};
+
+
+#endif //BREAKOUT_LANES_H
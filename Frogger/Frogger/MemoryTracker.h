@@ -0,0 +1,73 @@
+#ifndef BREAKOUT_MEMORYTRACKER_H
+#define BREAKOUT_MEMORYTRACKER_H
+
+
+#include <cstdint>
+
+
+// Counts heap allocations made through the global operator new, which
+// MemoryTracker.cpp replaces. Read the total twice and subtract to get
+// the allocations in between. Profiler zones do that with the count of
+// their own thread, so a trace shows which zone allocated.
+class MemoryTracker {
+public:
+    static uint64_t         allocations();          // every thread
+    static uint64_t         threadAllocations();    // this thread only
+
+    // the innermost profiler zone on this thread, named when an
+    // allocation is caught; enterZone() returns the one it replaces
+    static const char*      enterZone(const char* name);
+    static void             leaveZone(const char* previous);
+
+    // while set, an allocation on this thread aborts (ASSERT_NO_ALLOCATIONS
+    // builds only); forbid() returns the previous setting
+    static bool             forbid(bool forbidden);
+    static bool             forbidden();
+};
+
+
+// Build with ASSERT_NO_ALLOCATIONS and any allocation on this thread
+// while a NoAllocationScope is alive aborts, naming the profiler zone it
+// happened in. AllocationScope lifts that for code that allocates by
+// design. Without the define both do nothing.
+class NoAllocationScope {
+#ifdef ASSERT_NO_ALLOCATIONS
+private:
+    bool                    m_previous;
+
+public:
+    // a disabled scope leaves the setting as it is
+    explicit NoAllocationScope(bool enabled = true) : m_previous(MemoryTracker::forbidden()) {
+        if (enabled)
+            MemoryTracker::forbid(true);
+    }
+    ~NoAllocationScope() { MemoryTracker::forbid(m_previous); }
+#else
+public:
+    explicit NoAllocationScope(bool = true) {}
+#endif
+
+    NoAllocationScope(const NoAllocationScope&) = delete;
+    NoAllocationScope& operator=(const NoAllocationScope&) = delete;
+};
+
+
+class AllocationScope {
+#ifdef ASSERT_NO_ALLOCATIONS
+private:
+    bool                    m_previous;
+
+public:
+    AllocationScope() : m_previous(MemoryTracker::forbid(false)) {}
+    ~AllocationScope() { MemoryTracker::forbid(m_previous); }
+#else
+public:
+    AllocationScope() {}
+#endif
+
+    AllocationScope(const AllocationScope&) = delete;
+    AllocationScope& operator=(const AllocationScope&) = delete;
+};
+
+
+#endif //BREAKOUT_MEMORYTRACKER_H
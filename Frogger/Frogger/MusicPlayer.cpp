@@ -6,7 +6,15 @@
 #include <stdexcept>
 
 
+namespace {
+    bool nullBackend{ false };
+}
+
+
 MusicPlayer::MusicPlayer() {
+    if (!nullBackend)
+        m_music = std::make_unique<sf::Music>();
+
     m_filenames["menuTheme"] = "../assets/Music/dp_progger.flac";
     m_filenames["gameTheme"] = "../assets/Music/dp_frogger_tweener.flac";
 }
@@ -21,30 +29,43 @@ MusicPlayer& MusicPlayer::getInstance() {
 }
 
 
+void MusicPlayer::useNullBackend() {
+    nullBackend = true;
+}
+
+
 void MusicPlayer::play(String theme) {
-    if (!m_music.openFromFile(m_filenames[theme]))
+    if (!m_music)
+        return;
+
+    if (!m_music->openFromFile(m_filenames[theme]))
         throw std::runtime_error("Music could not open file");
 
-    m_music.setVolume(m_volume);
-    m_music.setLoop(true);
-    m_music.play();
+    m_music->setVolume(m_volume);
+    m_music->setLoop(true);
+    m_music->play();
 }
 
 
 void MusicPlayer::stop() {
-    m_music.stop();
+    if (m_music)
+        m_music->stop();
 }
 
 
 void MusicPlayer::setPaused(bool paused) {
+    if (!m_music)
+        return;
+
     if (paused)
-        m_music.pause();
+        m_music->pause();
     else
-        m_music.play();
+        m_music->play();
 }
 
 
 void MusicPlayer::setVolume(float volume) {
     m_volume = volume;
-    m_music.setVolume(m_volume);
+    if (m_music)
+        m_music->setVolume(m_volume);
 }
@@ -7,6 +7,7 @@
 
 #include <map>
 #include <string>
+#include <memory>
 #include <SFML/Audio/Music.hpp>
 
 using String = std::string;
@@ -20,6 +21,9 @@ private:
 public:
     static MusicPlayer& getInstance();
 
+    // call before the first getInstance(), for machines without audio
+    static void                     useNullBackend();
+
     // no copy or move for singleton
     MusicPlayer(const MusicPlayer&) = delete;
     MusicPlayer(MusicPlayer&&) = delete;
@@ -34,7 +38,7 @@ public:
 
 
 private:
-    sf::Music						m_music;
+    std::unique_ptr<sf::Music>		m_music;        // null backend when empty, sf::Music opens the audio device
     std::map<String, String>	    m_filenames;
     float							m_volume{ 25 };
 };
@@ -0,0 +1,26 @@
+#include "PerfStats.h"
+#include <algorithm>
+#include <cmath>
+
+
+void FrameTimes::add(float ms) {
+    m_ms[m_count % WINDOW] = ms;
+    ++m_count;
+}
+
+
+size_t FrameTimes::size() const {
+    return std::min(m_count, WINDOW);
+}
+
+
+float FrameTimes::percentile(float p) const {
+    const size_t n = size();
+    if (n == 0)
+        return 0.f;
+
+    m_sorted.assign(m_ms.begin(), m_ms.begin() + n);
+    const size_t k = std::min(n - 1, static_cast<size_t>(std::lround(p * (n - 1))));
+    std::nth_element(m_sorted.begin(), m_sorted.begin() + k, m_sorted.end());
+    return m_sorted[k];
+}
@@ -0,0 +1,62 @@
+#ifndef BREAKOUT_PERFSTATS_H
+#define BREAKOUT_PERFSTATS_H
+
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+
+// Event counts for the performance HUD. Any thread may add, the engine
+// takes the totals once per recorded frame.
+class PerfCounters {
+public:
+    enum Counter {
+        CollisionTests,
+        Count
+    };
+
+private:
+    static inline std::array<std::atomic<uint64_t>, Count>     s_values{};
+
+public:
+    static void add(Counter counter, uint64_t n = 1) {
+        s_values[counter].fetch_add(n, std::memory_order_relaxed);
+    }
+
+    // the count since the last take()
+    static uint64_t take(Counter counter) {
+        return s_values[counter].exchange(0, std::memory_order_relaxed);
+    }
+};
+
+
+// time spent in one part of a frame, named by a string that outlives it
+struct ZoneTime {
+    const char*                 name{ nullptr };
+    float                       ms{ 0.f };
+};
+
+
+// The last WINDOW frame times, percentiles say more about hitches than
+// an average frame rate does.
+class FrameTimes {
+public:
+    static constexpr size_t WINDOW{ 240 };
+
+private:
+    std::array<float, WINDOW>   m_ms{};
+    size_t                      m_count{ 0 };       // ever added
+    mutable std::vector<float>  m_sorted;
+
+public:
+    void                        add(float ms);
+    size_t                      size() const;
+
+    // p in [0, 1], 0 when empty
+    float                       percentile(float p) const;
+};
+
+
+#endif //BREAKOUT_PERFSTATS_H
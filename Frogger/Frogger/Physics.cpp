@@ -1,16 +1,238 @@
 #include "Physics.h"
+#include "PerfStats.h"
 #include <cmath>
 
-sf::Vector2f Physics::getOverlap(std::shared_ptr<Entity> a, std::shared_ptr<Entity> b)
+// the widest the build targets, MSVC sets __AVX2__ under /arch:AVX2 and
+// always has SSE2 on x64
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define PHYSICS_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define PHYSICS_SSE2
+#endif
+
+
+namespace {
+    using Shape = Physics::Shape;
+
+    // ORs the bit of every padded proxy of many into out, which the caller zeroed
+    template<Shape S>
+    void kernel(const CollisionProxy& a, uint32_t layers, const CollisionProxies& many, uint64_t* out) {
+        const float* cx = many.cx();
+        const float* cy = many.cy();
+        const float* hx = many.hx();
+        const float* hy = many.hy();
+        const uint32_t* layer = many.layer();
+        const size_t n = many.paddedSize();
+
+#if defined(PHYSICS_AVX2)
+        const __m256 sign = _mm256_set1_ps(-0.f);
+        const __m256 ax = _mm256_set1_ps(a.center.x), ay = _mm256_set1_ps(a.center.y);
+        const __m256 ahx = _mm256_set1_ps(a.halfSize.x), ahy = _mm256_set1_ps(a.halfSize.y);
+        const __m256i mask = _mm256_set1_epi32(static_cast<int>(layers));
+        const __m256i zero = _mm256_setzero_si256();
+
+        for (size_t i{ 0 }; i < n; i += 8) {
+            const __m256 dx = _mm256_sub_ps(_mm256_loadu_ps(cx + i), ax);
+            const __m256 dy = _mm256_sub_ps(_mm256_loadu_ps(cy + i), ay);
+            const __m256 rx = _mm256_add_ps(_mm256_loadu_ps(hx + i), ahx);
+
+            __m256 hit;
+            if constexpr (S == Shape::Box) {
+                const __m256 ry = _mm256_add_ps(_mm256_loadu_ps(hy + i), ahy);
+                hit = _mm256_and_ps(_mm256_cmp_ps(_mm256_andnot_ps(sign, dx), rx, _CMP_LT_OQ),
+                    _mm256_cmp_ps(_mm256_andnot_ps(sign, dy), ry, _CMP_LT_OQ));
+            }
+            else {
+                const __m256 d2 = _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy));
+                hit = _mm256_cmp_ps(d2, _mm256_mul_ps(rx, rx), _CMP_LT_OQ);
+            }
+
+            const __m256i off = _mm256_cmpeq_epi32(
+                _mm256_and_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(layer + i)), mask), zero);
+            hit = _mm256_andnot_ps(_mm256_castsi256_ps(off), hit);
+            out[i / 64] |= static_cast<uint64_t>(_mm256_movemask_ps(hit)) << (i % 64);
+        }
+#elif defined(PHYSICS_SSE2)
+        const __m128 sign = _mm_set1_ps(-0.f);
+        const __m128 ax = _mm_set1_ps(a.center.x), ay = _mm_set1_ps(a.center.y);
+        const __m128 ahx = _mm_set1_ps(a.halfSize.x), ahy = _mm_set1_ps(a.halfSize.y);
+        const __m128i mask = _mm_set1_epi32(static_cast<int>(layers));
+        const __m128i zero = _mm_setzero_si128();
+
+        for (size_t i{ 0 }; i < n; i += 4) {
+            const __m128 dx = _mm_sub_ps(_mm_loadu_ps(cx + i), ax);
+            const __m128 dy = _mm_sub_ps(_mm_loadu_ps(cy + i), ay);
+            const __m128 rx = _mm_add_ps(_mm_loadu_ps(hx + i), ahx);
+
+            __m128 hit;
+            if constexpr (S == Shape::Box) {
+                const __m128 ry = _mm_add_ps(_mm_loadu_ps(hy + i), ahy);
+                hit = _mm_and_ps(_mm_cmplt_ps(_mm_andnot_ps(sign, dx), rx),
+                    _mm_cmplt_ps(_mm_andnot_ps(sign, dy), ry));
+            }
+            else {
+                const __m128 d2 = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+                hit = _mm_cmplt_ps(d2, _mm_mul_ps(rx, rx));
+            }
+
+            const __m128i off = _mm_cmpeq_epi32(
+                _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(layer + i)), mask), zero);
+            hit = _mm_andnot_ps(_mm_castsi128_ps(off), hit);
+            out[i / 64] |= static_cast<uint64_t>(_mm_movemask_ps(hit)) << (i % 64);
+        }
+#else
+        for (size_t i{ 0 }; i < n; ++i) {
+            const float dx = cx[i] - a.center.x;
+            const float dy = cy[i] - a.center.y;
+            const float rx = hx[i] + a.halfSize.x;
+
+            bool hit;
+            if constexpr (S == Shape::Box)
+                hit = std::abs(dx) < rx && std::abs(dy) < hy[i] + a.halfSize.y;
+            else
+                hit = dx * dx + dy * dy < rx * rx;
+
+            if (hit && (layer[i] & layers))
+                out[i / 64] |= uint64_t{ 1 } << (i % 64);
+        }
+#endif
+    }
+
+
+    void oneVsMany(Shape shape, const CollisionProxy& a, uint32_t layers, const CollisionProxies& many, uint64_t* out) {
+        if (shape == Shape::Box)
+            kernel<Shape::Box>(a, layers, many, out);
+        else
+            kernel<Shape::Circle>(a, layers, many, out);
+    }
+}
+
+
+// a's motion relative to b, b stands still
+std::optional<float> Physics::sweptAABB(sf::Vector2f aFrom, sf::Vector2f aTo, sf::Vector2f aHalfSize,
+    sf::Vector2f bFrom, sf::Vector2f bTo, sf::Vector2f bHalfSize) {
+    PerfCounters::add(PerfCounters::CollisionTests);
+    const sf::Vector2f start = aFrom - bFrom;
+    const sf::Vector2f motion = (aTo - aFrom) - (bTo - bFrom);
+    const sf::Vector2f reach = aHalfSize + bHalfSize;
+
+    // the boxes overlap while both axes do, each axis over one interval
+    float enter{ 0.f };
+    float exit{ 1.f };
+    auto axis = [&](float p, float d, float r) {
+        if (d == 0.f)
+            return std::abs(p) < r;
+        float t0 = (-r - p) / d;
+        float t1 = (r - p) / d;
+        if (t0 > t1)
+            std::swap(t0, t1);
+        enter = std::max(enter, t0);
+        exit = std::min(exit, t1);
+        return enter < exit;
+    };
+
+    if (!axis(start.x, motion.x, reach.x) || !axis(start.y, motion.y, reach.y))
+        return std::nullopt;
+    return enter;
+}
+
+
+// solves |start + motion t| = reach for the first t
+std::optional<float> Physics::sweptCircle(sf::Vector2f aFrom, sf::Vector2f aTo, float aRadius,
+    sf::Vector2f bFrom, sf::Vector2f bTo, float bRadius) {
+    PerfCounters::add(PerfCounters::CollisionTests);
+    const sf::Vector2f start = aFrom - bFrom;
+    const sf::Vector2f motion = (aTo - aFrom) - (bTo - bFrom);
+    const float reach = aRadius + bRadius;
+
+    const float c = start.x * start.x + start.y * start.y - reach * reach;
+    if (c < 0.f)
+        return 0.f;
+
+    const float a = motion.x * motion.x + motion.y * motion.y;
+    const float b = start.x * motion.x + start.y * motion.y;
+    const float discriminant = b * b - a * c;
+    if (a == 0.f || b >= 0.f || discriminant <= 0.f)
+        return std::nullopt;     // no motion, moving apart or passing wide
+
+    const float t = (-b - std::sqrt(discriminant)) / a;
+    if (t > 1.f)
+        return std::nullopt;
+    return t;
+}
+
+
+void CollisionProxies::clear() {
+    m_cx.clear();
+    m_cy.clear();
+    m_hx.clear();
+    m_hy.clear();
+    m_layer.clear();
+    m_size = 0;
+}
+
+
+void CollisionProxies::add(const CollisionProxy& proxy) {
+    // the proxy takes the place of the first padding, if there is any
+    if (m_size == m_cx.size()) {
+        const size_t padded = m_size + PADDING;
+        m_cx.resize(padded, 0.f);
+        m_cy.resize(padded, 0.f);
+        m_hx.resize(padded, 0.f);
+        m_hy.resize(padded, 0.f);
+        m_layer.resize(padded, 0);
+    }
+
+    m_cx[m_size] = proxy.center.x;
+    m_cy[m_size] = proxy.center.y;
+    m_hx[m_size] = proxy.halfSize.x;
+    m_hy[m_size] = proxy.halfSize.y;
+    m_layer[m_size] = proxy.layer;
+    ++m_size;
+}
+
+
+CollisionProxy CollisionProxies::operator[](size_t i) const {
+    return CollisionProxy{ { m_cx[i], m_cy[i] }, { m_hx[i], m_hy[i] }, m_layer[i] };
+}
+
+
+void Physics::overlapOneVsMany(Shape shape, const CollisionProxy& a, const CollisionProxies& many,
+    uint32_t layers, std::vector<uint64_t>& hits) {
+    PerfCounters::add(PerfCounters::CollisionTests, many.size());
+    hits.assign(maskWords(many.size()), 0);
+    if (many.size() > 0)
+        oneVsMany(shape, a, layers, many, hits.data());
+}
+
+
+void Physics::overlapManyVsMany(Shape shape, const CollisionProxies& a, const CollisionProxies& b,
+    std::vector<uint64_t>& hits) {
+    PerfCounters::add(PerfCounters::CollisionTests, a.size() * b.size());
+    const size_t words = maskWords(b.size());
+    hits.assign(a.size() * words, 0);
+    if (b.size() == 0)
+        return;
+
+    for (size_t i{ 0 }; i < a.size(); ++i) {
+        const CollisionProxy proxy = a[i];
+        oneVsMany(shape, proxy, proxy.layer, b, hits.data() + i * words);
+    }
+}
+
+sf::Vector2f Physics::getOverlap(Entity a, Entity b)
 {
+    PerfCounters::add(PerfCounters::CollisionTests);
     sf::Vector2f overlap(0.f, 0.f);
-    if (!a->hasComponent<CBoundingBox>() or !b->hasComponent<CBoundingBox>())
+    if (!a.hasComponent<CBoundingBox>() or !b.hasComponent<CBoundingBox>())
         return overlap;
 
-    auto atx = a->getComponent<CTransform>();
-    auto abb = a->getComponent<CBoundingBox>();
-    auto btx = b->getComponent<CTransform>();
-    auto bbb = b->getComponent<CBoundingBox>();
+    const auto& atx = a.getComponent<CTransform>();
+    const auto& abb = a.getComponent<CBoundingBox>();
+    const auto& btx = b.getComponent<CTransform>();
+    const auto& bbb = b.getComponent<CBoundingBox>();
 
 
     if (abb.has && bbb.has)
@@ -22,16 +244,17 @@ sf::Vector2f Physics::getOverlap(std::shared_ptr<Entity> a, std::shared_ptr<Enti
     return overlap;
 }
 
-sf::Vector2f Physics::getPreviousOverlap(std::shared_ptr<Entity> a, std::shared_ptr<Entity> b)
+sf::Vector2f Physics::getPreviousOverlap(Entity a, Entity b)
 {
+    PerfCounters::add(PerfCounters::CollisionTests);
     sf::Vector2f overlap(0.f, 0.f);
-    if (!a->hasComponent<CBoundingBox>() or !b->hasComponent<CBoundingBox>())
+    if (!a.hasComponent<CBoundingBox>() or !b.hasComponent<CBoundingBox>())
         return overlap;
 
-    auto atx = a->getComponent<CTransform>();
-    auto abb = a->getComponent<CBoundingBox>();
-    auto btx = b->getComponent<CTransform>();
-    auto bbb = b->getComponent<CBoundingBox>();
+    const auto& atx = a.getComponent<CTransform>();
+    const auto& abb = a.getComponent<CBoundingBox>();
+    const auto& btx = b.getComponent<CTransform>();
+    const auto& bbb = b.getComponent<CBoundingBox>();
 
     if (abb.has && bbb.has)
     {
@@ -41,3 +264,119 @@ sf::Vector2f Physics::getPreviousOverlap(std::shared_ptr<Entity> a, std::shared_
     }
     return overlap;
 }
+
+
+const Physics::World::Body* Physics::World::find(Entity e) const {
+    if (e.index() >= m_index.size() || m_index[e.index()] == NONE)
+        return nullptr;
+    const Body& body = m_bodies[m_index[e.index()]];
+    return body.entity == e ? &body : nullptr;
+}
+
+
+void Physics::World::add(Entity e, const AABB& box) {
+    if (e.index() >= m_index.size())
+        m_index.resize(e.index() + 1, NONE);
+    if (m_index[e.index()] != NONE)
+        remove(m_bodies[m_index[e.index()]].entity);
+
+    m_index[e.index()] = static_cast<uint32_t>(m_bodies.size());
+    m_bodies.push_back(Body{ e, box, m_tree.create(box, e.index()) });
+}
+
+
+void Physics::World::update(Entity e, const AABB& box, sf::Vector2f displacement) {
+    if (!find(e)) {
+        add(e, box);
+        return;
+    }
+    Body& body = m_bodies[m_index[e.index()]];
+    body.box = box;
+    m_tree.move(body.proxy, box, displacement);
+}
+
+
+void Physics::World::remove(Entity e) {
+    if (!find(e))
+        return;
+
+    const uint32_t at = m_index[e.index()];
+    m_tree.destroy(m_bodies[at].proxy);
+    m_index[e.index()] = NONE;
+
+    // the last body fills the gap
+    if (at + 1 != m_bodies.size()) {
+        m_bodies[at] = m_bodies.back();
+        m_index[m_bodies[at].entity.index()] = at;
+    }
+    m_bodies.pop_back();
+}
+
+
+void Physics::World::clear() {
+    m_tree.clear();
+    m_bodies.clear();
+    m_index.clear();
+}
+
+
+void Physics::World::sync(Entity e) {
+    const auto& tfm = e.getComponent<CTransform>();
+    const auto& bb = e.getComponent<CBoundingBox>();
+    update(e, AABB::around(tfm.pos, bb.halfSize), tfm.pos - tfm.prevPos);
+}
+
+
+void Physics::World::pairs(std::vector<Pair>& out) const {
+    out.clear();
+    uint64_t tests{ 0 };
+    for (uint32_t i{ 0 }; i < m_bodies.size(); ++i) {
+        const Body& body = m_bodies[i];
+        m_tree.query(body.box, [&](int32_t proxy) {
+            const uint32_t j = m_index[m_tree.data(proxy)];
+            if (j > i) {
+                ++tests;
+                if (body.box.overlaps(m_bodies[j].box))
+                    out.emplace_back(body.entity, m_bodies[j].entity);
+            }
+            return true;
+        });
+    }
+    PerfCounters::add(PerfCounters::CollisionTests, tests);
+}
+
+
+void Physics::World::queryPoint(sf::Vector2f point, std::vector<Entity>& out) const {
+    queryBox(AABB{ point, point }, out);
+}
+
+
+void Physics::World::queryBox(const AABB& box, std::vector<Entity>& out) const {
+    out.clear();
+    uint64_t tests{ 0 };
+    m_tree.query(box, [&](int32_t proxy) {
+        const Body& body = m_bodies[m_index[m_tree.data(proxy)]];
+        ++tests;
+        if (body.box.overlaps(box))
+            out.push_back(body.entity);
+        return true;
+    });
+    PerfCounters::add(PerfCounters::CollisionTests, tests);
+}
+
+
+std::optional<Physics::RayHit> Physics::World::raycast(sf::Vector2f from, sf::Vector2f to) const {
+    std::optional<RayHit> first;
+    uint64_t tests{ 0 };
+    m_tree.raycast(from, to, [&](int32_t proxy, float limit) {
+        const Body& body = m_bodies[m_index[m_tree.data(proxy)]];
+        ++tests;
+        const auto t = body.box.raycast(from, to, limit);
+        if (!t)
+            return limit;
+        first = RayHit{ body.entity, *t, from + *t * (to - from) };
+        return *t;
+    });
+    PerfCounters::add(PerfCounters::CollisionTests, tests);
+    return first;
+}
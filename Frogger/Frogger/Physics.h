@@ -2,6 +2,7 @@
 
 
 #include "Entity.h"
+#include "AABBTree.h"
 
 #include <SFML/Graphics.hpp>
 #include <SFML/Audio.hpp>
@@ -12,11 +13,134 @@
 #include <fstream>
 #include <sstream>
 #include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <utility>
+
+
+// A collision shape as plain data, no entity lookups. A box uses both
+// half extents, a circle halfSize.x as its radius. Queries pass a mask
+// of layers, a proxy takes part if it is on one of them.
+struct CollisionProxy {
+	sf::Vector2f		center;
+	sf::Vector2f		halfSize;
+	uint32_t		layer{ 1 };
+};
+
+
+// Proxies kept one array per field, so the kernels load a lane of each
+// field at once. The arrays are padded to a multiple of PADDING with
+// proxies on no layer, which never hit, so the kernels need no tail.
+class CollisionProxies {
+public:
+	static constexpr size_t PADDING{ 8 };
+
+private:
+	std::vector<float>		m_cx, m_cy, m_hx, m_hy;
+	std::vector<uint32_t>	m_layer;
+	size_t					m_size{ 0 };
+
+public:
+	void					clear();
+	void					add(const CollisionProxy& proxy);
+	size_t					size() const { return m_size; }
+	size_t					paddedSize() const { return m_cx.size(); }
+	CollisionProxy			operator[](size_t i) const;
+
+	const float*			cx() const { return m_cx.data(); }
+	const float*			cy() const { return m_cy.data(); }
+	const float*			hx() const { return m_hx.data(); }
+	const float*			hy() const { return m_hy.data(); }
+	const uint32_t*			layer() const { return m_layer.data(); }
+};
 
 
 namespace Physics
 {
-	sf::Vector2f getOverlap(std::shared_ptr<Entity> a, std::shared_ptr<Entity> b);
-	sf::Vector2f getPreviousOverlap(std::shared_ptr<Entity> a, std::shared_ptr<Entity> b);
+	sf::Vector2f getOverlap(Entity a, Entity b);
+	sf::Vector2f getPreviousOverlap(Entity a, Entity b);
+
+	// Two shapes moving in straight lines from ...From to ...To over one
+	// update: the fraction of the update, in [0, 1], at which they first
+	// overlap, 0 if they already do, nothing if they never do. Nothing
+	// passes through anything between updates however far it moves.
+	std::optional<float> sweptAABB(sf::Vector2f aFrom, sf::Vector2f aTo, sf::Vector2f aHalfSize,
+		sf::Vector2f bFrom, sf::Vector2f bTo, sf::Vector2f bHalfSize);
+	std::optional<float> sweptCircle(sf::Vector2f aFrom, sf::Vector2f aTo, float aRadius,
+		sf::Vector2f bFrom, sf::Vector2f bTo, float bRadius);
+
+	enum class Shape { Box, Circle };
+
+	constexpr uint32_t ALL_LAYERS{ ~0u };
+
+	// 64 proxies per word of a hit mask
+	constexpr size_t maskWords(size_t proxies) { return (proxies + 63) / 64; }
+	inline bool isHit(const uint64_t* mask, size_t i) { return (mask[i / 64] >> (i % 64)) & 1; }
+
+	// Bit i of hits says whether many[i] overlaps a, touching is no hit.
+	// hits gets maskWords(many.size()) words. AVX2 builds test eight
+	// proxies at a time, SSE2 builds four, anything else one.
+	void overlapOneVsMany(Shape shape, const CollisionProxy& a, const CollisionProxies& many,
+		uint32_t layers, std::vector<uint64_t>& hits);
+
+	// Row i of hits is a[i] against every b, maskWords(b.size()) words per
+	// row. Proxy i of a is tested on the layers it is on.
+	void overlapManyVsMany(Shape shape, const CollisionProxies& a, const CollisionProxies& b,
+		std::vector<uint64_t>& hits);
+
+	struct RayHit {
+		Entity			entity;
+		float			fraction;		// along the ray, in [0, 1]
+		sf::Vector2f	point;
+	};
+
+	// The boxes of a set of entities in an AABBTree, for the questions that
+	// are not about one lane: which pairs overlap, what is at a point or in
+	// a region, what a ray hits first. Boxes come in through add() and
+	// update(), or sync() from an entity's CTransform and CBoundingBox; the
+	// tight boxes are kept so answers are exact, the fat ones only prune.
+	class World {
+	public:
+		using Pair = std::pair<Entity, Entity>;
+
+	private:
+		struct Body {
+			Entity			entity;
+			AABB			box;
+			int32_t			proxy;
+		};
+
+		static constexpr uint32_t NONE{ ~0u };
+
+		AABBTree				m_tree;
+		std::vector<Body>		m_bodies;
+		std::vector<uint32_t>	m_index;		// entity index to m_bodies, NONE if absent; tree data is the entity index
+
+		const Body*				find(Entity e) const;
+
+	public:
+		explicit World(float margin = 4.f) : m_tree(margin) {}
+
+		void					add(Entity e, const AABB& box);
+		void					update(Entity e, const AABB& box, sf::Vector2f displacement = {});
+		void					remove(Entity e);
+		void					clear();
+
+		// the box around CTransform::pos, moved on from prevPos; added if need be
+		void					sync(Entity e);
+
+		bool					contains(Entity e) const { return find(e) != nullptr; }
+		size_t					size() const { return m_bodies.size(); }
+		const AABBTree&			tree() const { return m_tree; }
+
+		// Every overlapping pair once, touching boxes do not overlap.
+		// The out parameters are cleared first and keep their capacity.
+		void					pairs(std::vector<Pair>& out) const;
+		void					queryPoint(sf::Vector2f point, std::vector<Entity>& out) const;
+		void					queryBox(const AABB& box, std::vector<Entity>& out) const;
+
+		// the first box the segment from -> to enters, starting inside counts at 0
+		std::optional<RayHit>	raycast(sf::Vector2f from, sf::Vector2f to) const;
+	};
 };
 
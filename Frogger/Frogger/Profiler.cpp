@@ -0,0 +1,92 @@
+#include "Profiler.h"
+#include "json.hpp"
+#include <fstream>
+#include <iostream>
+
+
+Profiler::Profiler() : m_start(Clock::now()) {
+}
+
+
+Profiler& Profiler::getInstance() {
+    static Profiler instance; // Meyers Singleton implementation
+    return instance;
+}
+
+
+int64_t Profiler::now() const {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - m_start).count();
+}
+
+
+// first zone on a thread registers its ring
+Profiler::ThreadBuffer& Profiler::buffer() {
+    if (!t_buffer) {
+        auto buffer = std::make_unique<ThreadBuffer>();
+        std::lock_guard<std::mutex> lock(m_mutex);
+        buffer->tid = static_cast<uint32_t>(m_threads.size());
+        buffer->name = "thread " + std::to_string(buffer->tid);
+        t_buffer = buffer.get();
+        m_threads.push_back(std::move(buffer));
+    }
+    return *t_buffer;
+}
+
+
+void Profiler::record(const char* name, int64_t startNs, int64_t endNs, uint64_t allocations) {
+    auto& ring = buffer();
+    const uint64_t head = ring.head.load(std::memory_order_relaxed);
+    ring.events[head % RING_SIZE] = Event{ name, startNs, endNs - startNs, allocations };
+    ring.head.store(head + 1, std::memory_order_release);
+}
+
+
+void Profiler::setThreadName(const std::string& name) {
+    auto& ring = buffer();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ring.name = name;
+}
+
+
+const char* Profiler::intern(const std::string& name) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_names.insert(name).first->c_str();
+}
+
+
+bool Profiler::writeTrace(const std::string& path) {
+    if (!ENABLED)
+        return false;
+
+    using json = nlohmann::json;
+    json events = json::array();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const auto& ring : m_threads) {
+        events.push_back({ { "name", "thread_name" }, { "ph", "M" }, { "pid", 0 }, { "tid", ring->tid },
+            { "args", { { "name", ring->name } } } });
+
+        // The owner keeps recording while we copy, so drop the slots it
+        // reached in the meantime, including the one it may be writing.
+        const uint64_t head = ring->head.load(std::memory_order_acquire);
+        std::vector<Event> copy(ring->events.begin(), ring->events.end());
+        const uint64_t after = ring->head.load(std::memory_order_acquire) + 1;
+        const uint64_t first = after > RING_SIZE ? after - RING_SIZE : 0;
+
+        for (uint64_t i{ first }; i < head; ++i) {
+            const auto& e = copy[i % RING_SIZE];
+            events.push_back({ { "name", e.name }, { "ph", "X" }, { "pid", 0 }, { "tid", ring->tid },
+                { "ts", e.startNs / 1000.0 }, { "dur", e.durationNs / 1000.0 },
+                { "args", { { "allocations", e.allocations } } } });
+        }
+    }
+
+    std::ofstream out(path);
+    if (out.fail()) {
+        std::cerr << "Open file " << path << " failed\n";
+        return false;
+    }
+    out << json{ { "traceEvents", events }, { "displayTimeUnit", "ms" } };
+    std::cout << "Wrote trace: " << path << std::endl;
+    return true;
+}
@@ -0,0 +1,129 @@
+#ifndef BREAKOUT_PROFILER_H
+#define BREAKOUT_PROFILER_H
+
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "MemoryTracker.h"
+
+
+// Scoped timing zones, written as Chrome trace_event JSON (chrome://tracing
+// or ui.perfetto.dev). Build with ENABLE_PROFILING to record; without it
+// PROFILE_ZONE and PROFILE_THREAD expand to nothing.
+//
+//     void Scene_Frogger::sCollisions() {
+//         PROFILE_ZONE("sCollisions");
+//         ...
+//     }
+//
+// Each thread records into its own ring buffer, so a zone is two clock
+// reads and a store. When a ring is full the oldest zones are overwritten.
+// A zone also counts the heap allocations its thread made while it was
+// open, nested zones included; the trace shows them as args.
+class Profiler {
+public:
+#ifdef ENABLE_PROFILING
+    static constexpr bool   ENABLED{ true };
+#else
+    static constexpr bool   ENABLED{ false };
+#endif
+
+    using Clock = std::chrono::steady_clock;
+
+    struct Event {
+        const char*         name{ nullptr };    // must outlive the profiler, see intern()
+        int64_t             startNs{ 0 };
+        int64_t             durationNs{ 0 };
+        uint64_t            allocations{ 0 };
+    };
+
+private:
+    static constexpr size_t RING_SIZE{ 1 << 15 };
+
+    // written by its thread only, read by writeTrace()
+    struct ThreadBuffer {
+        std::array<Event, RING_SIZE>    events;
+        std::atomic<uint64_t>           head{ 0 };      // events ever recorded
+        uint32_t                        tid{ 0 };
+        std::string                     name;
+    };
+
+    // singleton class
+    Profiler();
+    ~Profiler() = default;
+
+    Clock::time_point                           m_start;
+    std::mutex                                  m_mutex;    // registration and interning, never per zone
+    std::vector<std::unique_ptr<ThreadBuffer>>  m_threads;
+    std::unordered_set<std::string>             m_names;
+
+    static inline thread_local ThreadBuffer*    t_buffer{ nullptr };
+
+    ThreadBuffer&           buffer();
+
+public:
+    static Profiler& getInstance();
+
+    // no copy or move
+    Profiler(const Profiler&) = delete;
+    Profiler(Profiler&&) = delete;
+    Profiler& operator=(const Profiler&) = delete;
+    Profiler& operator=(Profiler&&) = delete;
+
+    int64_t                 now() const;
+    void                    record(const char* name, int64_t startNs, int64_t endNs, uint64_t allocations = 0);
+    void                    setThreadName(const std::string& name);
+
+    // a stable copy of a runtime name, for zones named by data
+    const char*             intern(const std::string& name);
+
+    // every zone still in the rings; false if nothing was written
+    bool                    writeTrace(const std::string& path);
+};
+
+
+class ProfileZone {
+private:
+    const char*             m_name;
+    const char*             m_outer;            // the zone this one is nested in
+    uint64_t                m_allocations;
+    int64_t                 m_start;
+
+public:
+    explicit ProfileZone(const char* name)
+        : m_name(name)
+        , m_outer(MemoryTracker::enterZone(name))
+        , m_allocations(MemoryTracker::threadAllocations())
+        , m_start(Profiler::getInstance().now()) {}
+    ~ProfileZone() {
+        auto& profiler = Profiler::getInstance();
+        profiler.record(m_name, m_start, profiler.now(), MemoryTracker::threadAllocations() - m_allocations);
+        MemoryTracker::leaveZone(m_outer);
+    }
+
+    ProfileZone(const ProfileZone&) = delete;
+    ProfileZone& operator=(const ProfileZone&) = delete;
+};
+
+
+#define PROFILE_CONCAT_IMPL(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_IMPL(a, b)
+
+#ifdef ENABLE_PROFILING
+#define PROFILE_ZONE(name) ProfileZone PROFILE_CONCAT(profileZone, __LINE__)(name)
+#define PROFILE_THREAD(name) Profiler::getInstance().setThreadName(name)
+#else
+#define PROFILE_ZONE(name) ((void)0)
+#define PROFILE_THREAD(name) ((void)0)
+#endif
+
+
+#endif //BREAKOUT_PROFILER_H
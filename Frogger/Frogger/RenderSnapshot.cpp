@@ -0,0 +1,110 @@
+#include "RenderSnapshot.h"
+#include <algorithm>
+
+
+namespace {
+    sf::Vector2f lerp(sf::Vector2f from, sf::Vector2f to, float alpha) {
+        return from + (to - from) * alpha;
+    }
+}
+
+
+void RenderSnapshot::clear() {
+    idle = false;
+    clearColor.reset();
+    sprites.clear();
+    boxes.clear();
+    texts.clear();
+    chars.clear();
+
+    stats.simMs = 0.f;
+    stats.collisionTests = 0;
+    stats.soundVoices = 0;
+    stats.entitiesPerTag.clear();
+    stats.componentBytes.clear();
+    stats.zones.clear();
+    stats.allocations = 0;
+}
+
+
+void RenderSnapshot::add(const sf::Sprite& sprite) {
+    sprites.push_back(Sprite{
+        sprite.getTexture(),
+        sprite.getTextureRect(),
+        sprite.getPosition(),
+        sprite.getPosition(),
+        sprite.getOrigin(),
+        sprite.getScale(),
+        sprite.getRotation(),
+        sprite.getColor() });
+}
+
+
+void RenderSnapshot::addText(std::string_view string, const sf::Text& style) {
+    texts.push_back(Text{
+        static_cast<uint32_t>(chars.size()),
+        static_cast<uint32_t>(string.size()),
+        style.getFont(),
+        style.getCharacterSize(),
+        style.getPosition(),
+        style.getFillColor() });
+    chars.append(string);
+}
+
+
+float RenderSnapshot::alphaAt(Clock::time_point now) const {
+    if (step <= sf::Time::Zero)
+        return 1.f;
+    const float since = std::chrono::duration<float>(now - time).count();
+    return std::clamp(since / step.asSeconds(), 0.f, 1.f);
+}
+
+
+size_t draw(sf::RenderTarget& target, const RenderSnapshot& frame, float alpha) {
+    size_t calls{ 0 };
+    target.setView(frame.view);
+    if (frame.clearColor)
+        target.clear(*frame.clearColor);
+
+    sf::Sprite sprite;
+    for (const auto& s : frame.sprites) {
+        if (!s.texture)
+            continue;
+        sprite.setTexture(*s.texture);
+        sprite.setTextureRect(s.textureRect);
+        sprite.setOrigin(s.origin);
+        sprite.setPosition(lerp(s.previous, s.position, alpha));
+        sprite.setRotation(s.rotation);
+        sprite.setScale(s.scale);
+        sprite.setColor(s.color);
+        target.draw(sprite);
+        ++calls;
+    }
+
+    sf::RectangleShape rect;
+    rect.setFillColor(sf::Color(0, 0, 0, 0));
+    for (const auto& b : frame.boxes) {
+        rect.setSize(b.size);
+        rect.setOrigin(b.size / 2.f);
+        rect.setPosition(lerp(b.previous, b.center, alpha));
+        rect.setOutlineColor(b.outline);
+        rect.setOutlineThickness(b.thickness);
+        target.draw(rect);
+        ++calls;
+    }
+
+    sf::Text text;
+    for (const auto& t : frame.texts) {
+        if (!t.font)
+            continue;
+        text.setFont(*t.font);
+        const char* first = frame.chars.data() + t.first;
+        text.setString(sf::String::fromUtf8(first, first + t.length));
+        text.setCharacterSize(t.characterSize);
+        text.setPosition(t.position);
+        text.setFillColor(t.color);
+        target.draw(text);
+        ++calls;
+    }
+    return calls;
+}
@@ -0,0 +1,96 @@
+#ifndef BREAKOUT_RENDERSNAPSHOT_H
+#define BREAKOUT_RENDERSNAPSHOT_H
+
+
+#include <vector>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <chrono>
+#include <cstdint>
+#include <SFML/Graphics.hpp>
+
+#include "PerfStats.h"
+
+
+// Everything the main thread needs to draw one frame. The simulation
+// thread records it and hands it over through a TripleBuffer, after that
+// nobody writes to it, so drawing never touches the entities. Textures
+// and fonts are referenced, Assets keeps them alive.
+//
+// Moving items also carry where they were one update earlier. The main
+// thread draws them blended by how far it is into the next update, so
+// motion stays smooth when the display rate is not a multiple of the
+// simulation rate, at the cost of one update of latency.
+struct RenderSnapshot {
+    using Clock = std::chrono::steady_clock;
+
+    struct Sprite {
+        const sf::Texture*  texture{ nullptr };
+        sf::IntRect         textureRect;
+        sf::Vector2f        position;
+        sf::Vector2f        previous;           // position one update earlier
+        sf::Vector2f        origin;
+        sf::Vector2f        scale{ 1.f, 1.f };
+        float               rotation{ 0.f };
+        sf::Color           color{ sf::Color::White };
+    };
+
+    // outlined box around its centre, debug overlays
+    struct Box {
+        sf::Vector2f        center;
+        sf::Vector2f        previous;           // center one update earlier
+        sf::Vector2f        size;
+        sf::Color           outline;
+        float               thickness{ 1.f };
+    };
+
+    // the string is [first, first + length) of chars
+    struct Text {
+        uint32_t            first{ 0 };
+        uint32_t            length{ 0 };
+        const sf::Font*     font{ nullptr };
+        unsigned int        characterSize{ 30 };
+        sf::Vector2f        position;
+        sf::Color           color{ sf::Color::White };
+    };
+
+    // what the simulation did for this frame, for the HUD
+    struct Stats {
+        float                   simMs{ 0.f };           // updates and recording
+        uint64_t                collisionTests{ 0 };
+        size_t                  soundVoices{ 0 };
+        std::vector<uint32_t>   entitiesPerTag;         // indexed by TagId
+        std::vector<size_t>     componentBytes;         // pool memory, indexed like ComponentTuple
+        std::vector<ZoneTime>   zones;                  // where simMs went
+        uint64_t                allocations{ 0 };       // on the simulation thread, since the last frame
+    };
+
+    Clock::time_point           time;       // when the last update was due
+    sf::Time                    step;       // time per update
+    bool                        idle{ false };  // nothing moves until the next input
+    sf::View                    view;
+    std::optional<sf::Color>    clearColor;
+    std::vector<Sprite>         sprites;    // back to front
+    std::vector<Box>            boxes;      // over the sprites
+    std::vector<Text>           texts;      // over everything
+    std::string                 chars;      // the text of every Text, back to back
+    Stats                       stats;
+
+    // keeps the capacity, a recycled buffer stops allocating after a few frames
+    void                        clear();
+
+    void                        add(const sf::Sprite& sprite);
+    // the string, with font, size, position and colour of style
+    void                        addText(std::string_view string, const sf::Text& style);
+
+    // 0 at the last update, 1 when the next one is due
+    float                       alphaAt(Clock::time_point now) const;
+};
+
+
+// main thread only, alpha blends previous to current positions; returns the draw calls
+size_t draw(sf::RenderTarget& target, const RenderSnapshot& frame, float alpha = 1.f);
+
+
+#endif //BREAKOUT_RENDERSNAPSHOT_H
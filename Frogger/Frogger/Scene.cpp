@@ -1,4 +1,5 @@
 #include "Scene.h"
+#include <chrono>
 
 
 Scene::Scene(GameEngine* gameEngine) : m_game(gameEngine)
@@ -13,8 +14,24 @@ void Scene::setPaused(bool paused)
 }
 
 
-void Scene::simulate(int)
-{}
+// Stops early once the scene is no longer current, e.g. the level ended.
+double Scene::simulate(int ticks)
+{
+	const sf::Time dt = m_game->timePerUpdate();
+	const auto start = std::chrono::steady_clock::now();
+
+	int done{ 0 };
+	for (; done < ticks && m_game->currentScene() == this; ++done)
+		update(dt);
+
+	const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	return elapsed > 0. ? done / elapsed : 0.;
+}
+
+bool Scene::isIdle() const
+{
+	return m_isPaused;
+}
 
 void Scene::doAction(Command command)
 {
@@ -22,11 +39,32 @@ void Scene::doAction(Command command)
 }
 
 
-const CommandMap Scene::getActionMap() const
+void Scene::onEnter()
+{}
+
+void Scene::reset()
+{}
+
+void Scene::takeTimings(std::vector<ZoneTime>&)
+{}
+
+const CommandMap& Scene::getActionMap() const
 {
 	return m_commands;
 }
 
+void Scene::countEntities(std::vector<uint32_t>& perTag)
+{
+	perTag.resize(TagRegistry::getInstance().size());
+	for (size_t tag{ 0 }; tag < perTag.size(); ++tag)
+		perTag[tag] = static_cast<uint32_t>(m_entityManager.getEntities(static_cast<TagId>(tag)).size());
+}
+
+void Scene::componentMemory(std::vector<size_t>& bytes) const
+{
+	m_entityManager.componentMemory(bytes);
+}
+
 void Scene::registerAction(int inputKey, std::string command)
 {
 	m_commands[inputKey] = command;
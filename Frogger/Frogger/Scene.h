@@ -3,6 +3,7 @@
 #include "EntityManager.h"
 #include "GameEngine.h"
 #include "Command.h"
+#include "RenderSnapshot.h"
 #include <map>
 #include <string>
 
@@ -32,11 +33,17 @@ public:
 
 	virtual void		update(sf::Time dt) = 0;
 	virtual void		sDoAction(const Command& action) = 0;
-	virtual void		sRender() = 0;
+	virtual void		sRender(RenderSnapshot& frame) = 0;    // records the frame, the main thread draws it
+	virtual bool		isIdle() const;							// nothing moves until the next input
+	virtual void		onEnter();								// became the current scene
+	virtual void		reset();								// back to the state it was built in
+	virtual void		takeTimings(std::vector<ZoneTime>& zones);	// appends time per system since the last call
 
-	void				simulate(int);
+	double				simulate(int ticks);	// fixed updates back to back, returns ticks per second
 	void				doAction(Command);
 	void				registerAction(int, std::string);
-	const CommandMap	getActionMap() const;
+	void				countEntities(std::vector<uint32_t>& perTag);	// indexed by TagId
+	void				componentMemory(std::vector<size_t>& bytes) const;	// indexed like ComponentTuple
+	const CommandMap&	getActionMap() const;
 };
 
@@ -12,19 +12,34 @@
 #include "MusicPlayer.h"
 #include "Assets.h"
 #include "SoundPlayer.h"
+#include "Profiler.h"
+#include "MemoryTracker.h"
 #include <random>
+#include <array>
+#include <charconv>
 
 namespace {
     std::random_device rd;
     std::mt19937 rng(rd());
+
+    // "label n" in buffer, std::to_string would allocate every frame
+    template<size_t N>
+    std::string_view labelled(std::array<char, N>& buffer, std::string_view label, int n) {
+        char* end = std::copy(label.begin(), label.end(), buffer.data());
+        end = std::to_chars(end, buffer.data() + N, n).ptr;
+        return std::string_view(buffer.data(), end - buffer.data());
+    }
 }
 
 
 Scene_Frogger::Scene_Frogger(GameEngine* gameEngine, const std::string& levelPath)
     : Scene(gameEngine)
-    , m_worldView(gameEngine->window().getDefaultView()) {
+    , m_levelPath(levelPath)
+    , m_worldView(sf::FloatRect(sf::Vector2f(0.f, 0.f), gameEngine->windowSize()))
+    , m_systems(m_entityManager) {
     loadLevel(levelPath);
     registerActions();
+    registerSystems();
 
     m_text.setFont(Assets::getInstance().getFont("Arcade"));
 
@@ -53,31 +68,61 @@ Scene_Frogger::Scene_Frogger(GameEngine* gameEngine, const std::string& levelPat
     m_score = 0;
     m_lives = 3;
     m_reachGoal = 0;
+}
+
 
+// the constructor may run on a worker, the music starts here
+void Scene_Frogger::onEnter() {
     MusicPlayer::getInstance().play("gameTheme");
     MusicPlayer::getInstance().setVolume(50);
 }
 
 
+// Loads the level start over the live world, the pools and entity
+// lists keep their capacity so nothing is reallocated.
+void Scene_Frogger::reset() {
+    if (!m_checkpoint.empty())
+        loadState(m_checkpoint);
+    m_rewind.clear();
+    m_rewinding = false;
+    m_player.getComponent<CInput>().dir = 0;
+    setPaused(false);
+}
+
+
+void Scene_Frogger::takeTimings(std::vector<ZoneTime>& zones) {
+    m_systems.takeTimings(zones);
+}
+
+
 void Scene_Frogger::init(const std::string& path) {
 }
 
-void Scene_Frogger::sMovement(sf::Time dt) {
-    playerMovement();
+void Scene_Frogger::registerSystems() {
+    m_systems.addExclusive("playerState", [this](sf::Time) { checkPlayerState(); });
 
-    // move all objects
-    for (auto e : m_entityManager.getEntities()) {
-        if (e->hasComponent<CInput>())
-            continue; // player is moved in playerMovement
-        if (e->hasComponent<CTransform>()) {
-            auto& tfm = e->getComponent<CTransform>();
+    m_systems.addExclusive("playerMovement", [this](sf::Time) { playerMovement(); });
 
-            tfm.prevPos = tfm.pos;
+    // animation and movement touch different components and run side by side
+    m_systems.addEach<Reads<CState>, Writes<CAnimation>>("animation",
+        [this] { return m_entityManager.view<CAnimation>(); }, &Scene_Frogger::sAnimation);
+    m_systems.addEach<Reads<CInput>, Writes<CTransform>>("movement",
+        [this] { return m_entityManager.view<CTransform>(); }, &Scene_Frogger::sMovement);
 
-            tfm.pos += tfm.vel * dt.asSeconds();
-            tfm.angle += tfm.angVel * dt.asSeconds();
-        }
-    }
+    m_systems.addExclusive("collisions", [this](sf::Time dt) { sCollisions(dt); });
+    m_systems.addExclusive("score", [this](sf::Time) { updateScore(); });
+}
+
+
+// move all objects
+void Scene_Frogger::sMovement(sf::Time dt, CommandBuffer&, Entity e, CTransform& tfm) {
+    if (e.hasComponent<CInput>())
+        return; // player is moved in playerMovement
+
+    tfm.prevPos = tfm.pos;
+
+    tfm.pos += tfm.vel * dt.asSeconds();
+    tfm.angle += tfm.angVel * dt.asSeconds();
 }
 
 
@@ -86,6 +131,8 @@ void Scene_Frogger::registerActions() {
     registerAction(sf::Keyboard::Escape, "BACK");
     registerAction(sf::Keyboard::Q, "QUIT");
     registerAction(sf::Keyboard::C, "TOGGLE_COLLISION");
+    registerAction(sf::Keyboard::R, "REWIND");
+    registerAction(sf::Keyboard::Backspace, "RESTART");
 
     registerAction(sf::Keyboard::A, "LEFT");
     registerAction(sf::Keyboard::Left, "LEFT");
@@ -99,90 +146,108 @@ void Scene_Frogger::registerActions() {
 
 
 void Scene_Frogger::onEnd() {
-    m_game->changeScene("MENU", nullptr, false);
+    m_game->backLevel(m_levelPath);
 }
 
 void Scene_Frogger::playerMovement() {
     // no movement if player is dead
-    if (m_player->hasComponent<CState>() && m_player->getComponent<CState>().state == "dead")
+    if (m_player.hasComponent<CState>() && m_player.getComponent<CState>().state == "dead")
         return;
 
-    auto& dir = m_player->getComponent<CInput>().dir;
-    auto& pos = m_player->getComponent<CTransform>().pos;
+    auto& dir = m_player.getComponent<CInput>().dir;
+    auto& pos = m_player.getComponent<CTransform>().pos;
 
     if (dir & CInput::UP) {
-        m_player->addComponent<CAnimation>(Assets::getInstance().getAnimation("up"));
+        m_player.addComponent<CAnimation>(Assets::getInstance().getAnimation("up"));
         pos.y -= 40.f;
     }
     if (dir & CInput::DOWN) {
-        m_player->addComponent<CAnimation>(Assets::getInstance().getAnimation("down"));
+        m_player.addComponent<CAnimation>(Assets::getInstance().getAnimation("down"));
         pos.y += 40.f;
     }
 
     if (dir & CInput::LEFT) {
-        m_player->addComponent<CAnimation>(Assets::getInstance().getAnimation("left"));
+        m_player.addComponent<CAnimation>(Assets::getInstance().getAnimation("left"));
         pos.x -= 40.f;
     }
 
     if (dir & CInput::RIGHT) {
-        m_player->addComponent<CAnimation>(Assets::getInstance().getAnimation("right"));
+        m_player.addComponent<CAnimation>(Assets::getInstance().getAnimation("right"));
         pos.x += 40.f;
     }
 
     if (dir != 0) {
-        SoundPlayer::getInstance().play("hop", m_player->getComponent<CTransform>().pos);
+        SoundPlayer::getInstance().play("hop", m_player.getComponent<CTransform>().pos);
         dir = 0;
     }
 }
 
 
-void Scene_Frogger::sRender() {
-    m_game->window().setView(m_worldView);
+void Scene_Frogger::sRender(RenderSnapshot& frame) {
+    frame.view = m_worldView;
 
     // draw bkg first
-    for (auto e : m_entityManager.getEntities("bkg")) {
-        if (e->getComponent<CSprite>().has) {
-            auto& sprite = e->getComponent<CSprite>().sprite;
-            m_game->window().draw(sprite);
-        }
+    for (auto e : m_entityManager.getEntities(Tag::bkg)) {
+        if (e.getComponent<CSprite>().has)
+            frame.add(e.getComponent<CSprite>().sprite);
     }
 
-
-    for (auto& e : m_entityManager.getEntities()) {
-        if (!e->hasComponent<CAnimation>())
-            continue;
-
-        // Draw Sprite
-        auto& anim = e->getComponent<CAnimation>().animation;
-        auto& tfm = e->getComponent<CTransform>();
-        anim.getSprite().setPosition(tfm.pos);
-        anim.getSprite().setRotation(tfm.angle);
-        m_game->window().draw(anim.getSprite());
-
-        if (m_drawAABB) {
-            if (e->hasComponent<CBoundingBox>()) {
-                auto box = e->getComponent<CBoundingBox>();
-                sf::RectangleShape rect;
-                rect.setSize(sf::Vector2f{ box.size.x, box.size.y });
-                centerOrigin(rect);
-                rect.setPosition(e->getComponent<CTransform>().pos);
-                rect.setFillColor(sf::Color(0, 0, 0, 0));
-                rect.setOutlineColor(sf::Color{ 0, 255, 0 });
-                rect.setOutlineThickness(2.f);
-                m_game->window().draw(rect);
-            }
+    // lane obstacles under everything else, where they were at the last
+    // update unless they wrapped since
+    for (const auto& lane : m_lanes.lanes()) {
+        for (const auto& obstacle : m_lanes.obstacles(lane)) {
+            auto& anim = obstacle.entity.getComponent<CAnimation>().animation;
+            auto& rect = anim.getFrame();
+            const sf::Vector2f position(m_lanes.x(lane, obstacle, m_laneTime), lane.y);
+            sf::Vector2f previous(m_lanes.x(lane, obstacle, m_lanePrevious), lane.y);
+            if (std::abs(position.x - previous.x) > lane.period / 2.f)
+                previous = position;
+
+            RenderSnapshot::Sprite sprite;
+            sprite.texture = anim.getTexture();
+            sprite.textureRect = rect;
+            sprite.origin = sf::Vector2f(rect.width / 2.f, rect.height / 2.f);
+            sprite.position = position;
+            sprite.previous = previous;
+            frame.sprites.push_back(sprite);
+
+            if (m_drawAABB)
+                frame.boxes.push_back(RenderSnapshot::Box{ position, previous, 2.f * lane.halfSize, sf::Color{ 0, 255, 0 }, 2.f });
         }
     }
 
+    // the animation only says which frame, the transform where;
+    // the player hops a whole cell per update, it is not blended
+    m_entityManager.view<CAnimation, CTransform>().each([&frame](Entity e, CAnimation& cAnim, CTransform& tfm) {
+        auto& anim = cAnim.animation;
+        auto& rect = anim.getFrame();
+
+        RenderSnapshot::Sprite sprite;
+        sprite.texture = anim.getTexture();
+        sprite.textureRect = rect;
+        sprite.origin = sf::Vector2f(rect.width / 2.f, rect.height / 2.f);
+        sprite.position = tfm.pos;
+        sprite.previous = e.hasComponent<CInput>() ? tfm.pos : tfm.prevPos;
+        sprite.rotation = tfm.angle;
+        frame.sprites.push_back(sprite);
+        });
+
+    if (m_drawAABB) {
+        m_entityManager.view<CBoundingBox, CTransform>().each([&frame](Entity e, CBoundingBox& box, CTransform& tfm) {
+            if (e.hasComponent<CAnimation>())
+                frame.boxes.push_back(RenderSnapshot::Box{ tfm.pos, e.hasComponent<CInput>() ? tfm.pos : tfm.prevPos,
+                    box.size, sf::Color{ 0, 255, 0 }, 2.f });
+            });
+    }
+
+    std::array<char, 32> buffer;
     m_text.setPosition(5.0f, -5.0f);
-    m_text.setString("score  " + std::to_string(m_score));
-    m_game->window().draw(m_text);
+    frame.addText(labelled(buffer, "score  ", m_score), m_text);
 
     int time = static_cast<int>(std::ceil(m_timer.asSeconds()));
 
     m_text.setPosition(5.0f, 22.5f);
-    m_text.setString("time  " + std::to_string(time));
-    m_game->window().draw(m_text);
+    frame.addText(labelled(buffer, "time  ", time), m_text);
 }
 
 
@@ -194,187 +259,149 @@ void Scene_Frogger::sDoAction(const Command& action) {
     // On Key Press
     if (action.type() == "START") {
         if (action.name() == "PAUSE") { setPaused(!m_isPaused); }
-        else if (action.name() == "QUIT") { m_game->quitLevel(); }
-        else if (action.name() == "BACK") { m_game->backLevel(); }
+        else if (action.name() == "QUIT") { m_game->quitLevel(m_levelPath); return; }
+        else if (action.name() == "BACK") { m_game->backLevel(m_levelPath); return; }
 
         else if (action.name() == "TOGGLE_TEXTURE") { m_drawTextures = !m_drawTextures; }
         else if (action.name() == "TOGGLE_COLLISION") { m_drawAABB = !m_drawAABB; }
         else if (action.name() == "TOGGLE_GRID") { m_drawGrid = !m_drawGrid; }
 
+        else if (action.name() == "REWIND") { m_rewinding = true; }
+        else if (action.name() == "RESTART" && !m_checkpoint.empty()) {
+            loadState(m_checkpoint);
+            m_rewind.clear();
+        }
+
         // Player control
-        if (action.name() == "LEFT") { m_player->getComponent<CInput>().dir = CInput::LEFT; }
-        else if (action.name() == "RIGHT") { m_player->getComponent<CInput>().dir = CInput::RIGHT; }
-        else if (action.name() == "UP") { m_player->getComponent<CInput>().dir = CInput::UP; }
-        else if (action.name() == "DOWN") { m_player->getComponent<CInput>().dir = CInput::DOWN; }
+        if (action.name() == "LEFT") { m_player.getComponent<CInput>().dir = CInput::LEFT; }
+        else if (action.name() == "RIGHT") { m_player.getComponent<CInput>().dir = CInput::RIGHT; }
+        else if (action.name() == "UP") { m_player.getComponent<CInput>().dir = CInput::UP; }
+        else if (action.name() == "DOWN") { m_player.getComponent<CInput>().dir = CInput::DOWN; }
     }
     // on Key Release
     // the frog can only go in one direction at a time, no angles
     // use a bitset and exclusive setting.
+    else if (action.type() == "END" && action.name() == "REWIND") {
+        m_rewinding = false;
+    }
     else if (action.type() == "END" && (action.name() == "LEFT" || action.name() == "RIGHT" || action.name() == "UP" ||
         action.name() == "DOWN")) {
-        m_player->getComponent<CInput>().dir = 0;
+        m_player.getComponent<CInput>().dir = 0;
     }
 }
 
 
 void Scene_Frogger::spawnPlayer(sf::Vector2f pos) {
-    m_player = m_entityManager.addEntity("player");
-    m_player->addComponent<CTransform>(pos);
-    m_player->addComponent<CBoundingBox>(sf::Vector2f(15.f, 15.f));
-    m_player->addComponent<CInput>();
-    m_player->addComponent<CAnimation>(Assets::getInstance().getAnimation("up"));
+    m_player = m_entityManager.addEntity(Tag::player);
+    m_player.addComponent<CTransform>(pos);
+    m_player.addComponent<CBoundingBox>(sf::Vector2f(15.f, 15.f));
+    m_player.addComponent<CInput>();
+    m_player.addComponent<CAnimation>(Assets::getInstance().getAnimation("up"));
+}
+
+// every entity in a lane is a copy of one prefab, spaced out along x;
+// m_lanes knows where they are, they get no CTransform
+EntitySpan Scene_Frogger::spawnLane(const Prefab& prefab, sf::Vector2f position, sf::Vector2f velocity, float spacing, int count)
+{
+    // how far past the edge of the screen an obstacle goes before it wraps
+    const float offset = 20.0f;
+
+    auto lane = m_entityManager.instantiate(prefab, static_cast<size_t>(count));
+    m_lanes.add(prefab.tag(), lane, position, spacing, velocity.x, prefab.get<CBoundingBox>()->halfSize,
+        m_worldView.getSize().x, offset);
+    return lane;
 }
 
 void Scene_Frogger::spawnLane1()
 {
-    sf::Vector2f position(150.0f, 600.0f - 60.0f);
-    sf::Vector2f velocity(-40.0f, 0.0f);
+    Prefab car(Tag::car);
+    car.set<CAnimation>(Assets::getInstance().getAnimation("raceCarL"));
+    car.set<CBoundingBox>(sf::Vector2f(30.0f, 15.0f));
 
-    for (int i = 0; i < 3; ++i)
-    {
-        auto car = m_entityManager.addEntity("car");
-        car->addComponent<CAnimation>(Assets::getInstance().getAnimation("raceCarL"));
-        car->addComponent<CBoundingBox>(sf::Vector2f(30.0f, 15.0f));
-        car->addComponent<CTransform>(position, velocity);
-        position.x += 150.0f;
-    }
+    spawnLane(car, sf::Vector2f(150.0f, 600.0f - 60.0f), sf::Vector2f(-40.0f, 0.0f), 150.0f, 3);
 }
 
 void Scene_Frogger::spawnLane2()
 {
-    sf::Vector2f position(300.0f, 600.0f - 100.0f);
-    sf::Vector2f velocity(40.0f, 0.0f);
+    Prefab car(Tag::car);
+    car.set<CAnimation>(Assets::getInstance().getAnimation("tractor"));
+    car.set<CBoundingBox>(sf::Vector2f(30.0f, 15.0f));
 
-    for (int i = 0; i < 3; ++i)
-    {
-        auto car = m_entityManager.addEntity("car");
-        car->addComponent<CAnimation>(Assets::getInstance().getAnimation("tractor"));
-        car->addComponent<CBoundingBox>(sf::Vector2f(30.0f, 15.0f));
-        car->addComponent<CTransform>(position, velocity);
-        position.x -= 150.0f;
-    }
+    spawnLane(car, sf::Vector2f(300.0f, 600.0f - 100.0f), sf::Vector2f(40.0f, 0.0f), -150.0f, 3);
 }
 
 void Scene_Frogger::spawnLane3()
 {
-    sf::Vector2f position(150.0f, 600.0f - 140.0f);
-    sf::Vector2f velocity(-50.0f, 0.0f);
+    Prefab car(Tag::car);
+    car.set<CAnimation>(Assets::getInstance().getAnimation("car"));
+    car.set<CBoundingBox>(sf::Vector2f(30.0f, 15.0f));
 
-    for (int i = 0; i < 3; ++i)
-    {
-        auto car = m_entityManager.addEntity("car");
-        car->addComponent<CAnimation>(Assets::getInstance().getAnimation("car"));
-        car->addComponent<CBoundingBox>(sf::Vector2f(30.0f, 15.0f));
-        car->addComponent<CTransform>(position, velocity);
-        position.x += 150.0f;
-    }
+    spawnLane(car, sf::Vector2f(150.0f, 600.0f - 140.0f), sf::Vector2f(-50.0f, 0.0f), 150.0f, 3);
 }
 
 void Scene_Frogger::spawnLane4()
 {
-    sf::Vector2f position(300.0f, 600.0f - 180.0f);
-    sf::Vector2f velocity(60.0f, 0.0f);
+    Prefab car(Tag::car);
+    car.set<CAnimation>(Assets::getInstance().getAnimation("raceCarR"));
+    car.set<CBoundingBox>(sf::Vector2f(30.0f, 15.0f));
 
-    for (int i = 0; i < 3; ++i)
-    {
-        auto car = m_entityManager.addEntity("car");
-        car->addComponent<CAnimation>(Assets::getInstance().getAnimation("raceCarR"));
-        car->addComponent<CBoundingBox>(sf::Vector2f(30.0f, 15.0f));
-        car->addComponent<CTransform>(position, velocity);
-        position.x -= 150.0f;
-    }
+    spawnLane(car, sf::Vector2f(300.0f, 600.0f - 180.0f), sf::Vector2f(60.0f, 0.0f), -150.0f, 3);
 }
 
 void Scene_Frogger::spawnLane5()
 {
-    sf::Vector2f position(240.0f, 600.0f - 220.0f);
-    sf::Vector2f velocity(-70.0f, 0.0f);
+    Prefab car(Tag::car);
+    car.set<CAnimation>(Assets::getInstance().getAnimation("truck"));
+    car.set<CBoundingBox>(sf::Vector2f(50.0f, 15.0f));
 
-    for (int i = 0; i < 2; ++i)
-    {
-        auto car = m_entityManager.addEntity("car");
-        car->addComponent<CAnimation>(Assets::getInstance().getAnimation("truck"));
-        car->addComponent<CBoundingBox>(sf::Vector2f(50.0f, 15.0f));
-        car->addComponent<CTransform>(position, velocity);
-        position.x += 200.0f;
-    }
+    spawnLane(car, sf::Vector2f(240.0f, 600.0f - 220.0f), sf::Vector2f(-70.0f, 0.0f), 200.0f, 2);
 }
 
 void Scene_Frogger::spawnLane6()
 {
-    sf::Vector2f position(100.0f, 600.0f - 300.0f);
-    sf::Vector2f velocity(-40.0f, 0.0f);
+    Prefab turtles(Tag::turtles);
+    turtles.set<CAnimation>(Assets::getInstance().getAnimation("3turtles"));
+    turtles.set<CBoundingBox>(sf::Vector2f(80.0f, 15.0f));
 
-    for (int i = 0; i < 4; ++i)
-    {
-        auto turtles = m_entityManager.addEntity("turtles");
-        turtles->addComponent<CAnimation>(Assets::getInstance().getAnimation("3turtles"));
-        turtles->addComponent<CBoundingBox>(sf::Vector2f(80.0f, 15.0f));
-        turtles->addComponent<CTransform>(position, velocity);
-        if (i == 0) turtles->addComponent<CState>("animated");
-        position.x += 150.0f;
-    }
+    auto lane = spawnLane(turtles, sf::Vector2f(100.0f, 600.0f - 300.0f), sf::Vector2f(-40.0f, 0.0f), 150.0f, 4);
+    lane.front().addComponent<CState>("animated");
 }
 
 void Scene_Frogger::spawnLane7()
 {
-    sf::Vector2f position(400.0f, 600.0f - 340.0f);
-    sf::Vector2f velocity(40.0f, 0.0f);
+    Prefab tree(Tag::tree);
+    tree.set<CAnimation>(Assets::getInstance().getAnimation("tree1"));
+    tree.set<CBoundingBox>(sf::Vector2f(70.0f, 15.0f));
 
-    for (int i = 0; i < 3; ++i)
-    {
-        auto tree = m_entityManager.addEntity("tree");
-        tree->addComponent<CAnimation>(Assets::getInstance().getAnimation("tree1"));
-        tree->addComponent<CBoundingBox>(sf::Vector2f(70.0f, 15.0f));
-        tree->addComponent<CTransform>(position, velocity);
-        position.x -= 175.0f;
-    }
+    spawnLane(tree, sf::Vector2f(400.0f, 600.0f - 340.0f), sf::Vector2f(40.0f, 0.0f), -175.0f, 3);
 }
 
 void Scene_Frogger::spawnLane8()
 {
-    sf::Vector2f position(400.0f, 600.0f - 380.0f);
-    sf::Vector2f velocity(60.0f, 0.0f);
+    Prefab tree(Tag::tree);
+    tree.set<CAnimation>(Assets::getInstance().getAnimation("tree2"));
+    tree.set<CBoundingBox>(sf::Vector2f(170.0f, 15.0f));
 
-    for (int i = 0; i < 3; ++i)
-    {
-        auto tree = m_entityManager.addEntity("tree");
-        tree->addComponent<CAnimation>(Assets::getInstance().getAnimation("tree2"));
-        tree->addComponent<CBoundingBox>(sf::Vector2f(170.0f, 15.0f));
-        tree->addComponent<CTransform>(position, velocity);
-        position.x -= 230.0f;
-    }
+    spawnLane(tree, sf::Vector2f(400.0f, 600.0f - 380.0f), sf::Vector2f(60.0f, 0.0f), -230.0f, 3);
 }
 
 void Scene_Frogger::spawnLane9()
 {
-    sf::Vector2f position(175.0f, 600.0f - 420.0f);
-    sf::Vector2f velocity(-40.0f, 0.0f);
+    Prefab turtles(Tag::turtles);
+    turtles.set<CAnimation>(Assets::getInstance().getAnimation("2turtles"));
+    turtles.set<CBoundingBox>(sf::Vector2f(50.0f, 15.0f));
 
-    for (int i = 0; i < 4; ++i)
-    {
-        auto turtles = m_entityManager.addEntity("turtles");
-        turtles->addComponent<CAnimation>(Assets::getInstance().getAnimation("2turtles"));
-        turtles->addComponent<CBoundingBox>(sf::Vector2f(50.0f, 15.0f));
-        turtles->addComponent<CTransform>(position, velocity);
-        if (i == 0) turtles->addComponent<CState>("animated");
-        position.x += 130.0f;
-    }
+    auto lane = spawnLane(turtles, sf::Vector2f(175.0f, 600.0f - 420.0f), sf::Vector2f(-40.0f, 0.0f), 130.0f, 4);
+    lane.front().addComponent<CState>("animated");
 }
 
 void Scene_Frogger::spawnLane10()
 {
-    sf::Vector2f position(350.0f, 600.0f - 460.0f);
-    sf::Vector2f velocity(50.0f, 0.0f);
+    Prefab tree(Tag::tree);
+    tree.set<CAnimation>(Assets::getInstance().getAnimation("tree1"));
+    tree.set<CBoundingBox>(sf::Vector2f(70.0f, 15.0f));
 
-    for (int i = 0; i < 3; ++i)
-    {
-        auto tree = m_entityManager.addEntity("tree");
-        tree->addComponent<CAnimation>(Assets::getInstance().getAnimation("tree1"));
-        tree->addComponent<CBoundingBox>(sf::Vector2f(70.0f, 15.0f));
-        tree->addComponent<CTransform>(position, velocity);
-        position.x -= 175.0f;
-    }
+    spawnLane(tree, sf::Vector2f(350.0f, 600.0f - 460.0f), sf::Vector2f(50.0f, 0.0f), -175.0f, 3);
 }
 
 void Scene_Frogger::spawnGoal()
@@ -383,10 +410,12 @@ void Scene_Frogger::spawnGoal()
 
     for (int i = 0; i < 5; ++i)
     {
-        auto goal = m_entityManager.addEntity("goal");
-        goal->addComponent<CAnimation>(Assets::getInstance().getAnimation("lillyPad"));
-        goal->addComponent<CTransform>(sf::Vector2f(position));
-        goal->addComponent<CBoundingBox>(sf::Vector2f(20.0f, 20.0f));
+        auto goal = m_entityManager.addEntity(Tag::goal);
+        goal.addComponent<CAnimation>(Assets::getInstance().getAnimation("lillyPad"));
+        goal.addComponent<CTransform>(sf::Vector2f(position));
+        goal.addComponent<CBoundingBox>(sf::Vector2f(20.0f, 20.0f));
+        m_goals.push_back(goal);
+        m_goalProxies.add(CollisionProxy{ position, goal.getComponent<CBoundingBox>().halfSize });
         position.x += 102;
     }
 }
@@ -397,9 +426,9 @@ void Scene_Frogger::spawnLives()
 
     for (int i = 0; i < 3; ++i)
     {
-        auto lives = m_entityManager.addEntity("lives");
-        lives->addComponent<CAnimation>(Assets::getInstance().getAnimation("lives"));
-        lives->addComponent<CTransform>(position);
+        auto lives = m_entityManager.addEntity(Tag::lives);
+        lives.addComponent<CAnimation>(Assets::getInstance().getAnimation("lives"));
+        lives.addComponent<CTransform>(position);
         position.x += 20.0f;
     }
 }
@@ -408,95 +437,65 @@ sf::FloatRect Scene_Frogger::getViewBounds() {
     return sf::FloatRect();
 }
 
-void Scene_Frogger::sCollisions() {
-    adjustPlayerPosition();
-
-    for (auto& e : m_entityManager.getEntities())
-    {
-        const float offset = 20.0f;
-
-        auto& bounds = m_worldView.getSize();
+void Scene_Frogger::sCollisions(sf::Time dt) {
+    PROFILE_ZONE("sCollisions");
 
-        auto& transform = e->getComponent<CTransform>();
-        auto& half = e->getComponent<CBoundingBox>().halfSize;
-
-        auto& position = transform.pos;
-        auto& velocity = transform.vel;
-
-        if (velocity.x < 0 && position.x + half.x + offset < 0)
-            position.x = bounds.x + half.x + offset;
-
-        if (velocity.x > 0 && position.x - half.x - offset > bounds.x)
-            position.x = -half.x - offset;
-    }
+    adjustPlayerPosition();
 
-    auto& playerPosition = m_player->getComponent<CTransform>().pos;
+    // only the lane the frog is in can touch it
+    auto& playerPosition = m_player.getComponent<CTransform>().pos;
+    const auto& playerHalf = m_player.getComponent<CBoundingBox>().halfSize;
+    const Lanes::Lane* lane = m_lanes.at(playerPosition.y, playerHalf.y);
 
     if (playerPosition.y > 320.0f)
     {
-        for (auto& car : m_entityManager.getEntities("car"))
+        // nothing to test until a car can reach the frog where it sits
+        if (!lane || (playerPosition == m_safeAt && m_laneTime < m_safeUntil))
+            return;
+
+        // swept over the whole update, so a car that touched the frog at
+        // any moment since the last one hits it however long updates are;
+        // a hop counts from the start of the update
+        if (m_lanes.sweep(*lane, playerPosition, playerHalf, m_lanePrevious, m_laneTime))
         {
-            auto overlap = Physics::getOverlap(m_player, car);
-
-            if (overlap.x > 0 && overlap.y > 0)
-            {
-                killPlayer();
-                return;
-            }
+            killPlayer();
+            return;
         }
+
+        m_safeAt = playerPosition;
+        m_safeUntil = m_lanes.contact(*lane, playerPosition.x, playerHalf.x, m_laneTime);
     }
     else
     {
-        for (auto& turtles : m_entityManager.getEntities("turtles"))
+        // turtles and logs carry the frog along at the speed of their lane
+        if (auto obstacle = lane ? m_lanes.overlap(*lane, playerPosition.x, playerHalf.x, m_laneTime) : nullptr)
         {
-            auto overlap = Physics::getOverlap(m_player, turtles);
-
-            if (overlap.x > 0 && overlap.y > 0)
+            if (lane->tag == Tag::turtles && obstacle->entity.getComponent<CAnimation>().animation.m_currentFrame == 3)
             {
-                auto& animation = turtles->getComponent<CAnimation>().animation;
-
-                if (animation.m_currentFrame == 3)
-                {
-                    killPlayer();
-                    return;
-                }
-
-                auto& transform = turtles->getComponent<CTransform>();
-                float distance = transform.pos.x - transform.prevPos.x;
-
-                playerPosition.x += distance;
+                killPlayer();
                 return;
             }
-        }
-
-        for (auto& tree : m_entityManager.getEntities("tree"))
-        {
-            auto overlap = Physics::getOverlap(m_player, tree);
 
-            if (overlap.x > 0 && overlap.y > 0)
-            {
-                auto& transform = tree->getComponent<CTransform>();
-                float distance = transform.pos.x - transform.prevPos.x;
-
-                playerPosition.x += distance;
-                return;
-            }
+            playerPosition.x += lane->velocity * dt.asSeconds();
+            return;
         }
 
-        for (auto& goal : m_entityManager.getEntities("goal"))
-        {
-            auto overlap = Physics::getOverlap(m_player, goal);
+        Physics::overlapOneVsMany(Physics::Shape::Box, CollisionProxy{ playerPosition, playerHalf },
+            m_goalProxies, Physics::ALL_LAYERS, m_hits);
 
-            if (overlap.x > 0 && overlap.y > 0)
+        for (size_t i{ 0 }; i < m_goals.size(); ++i)
+        {
+            if (Physics::isHit(m_hits.data(), i))
             {
-                if (goal->getComponent<CState>().state == "clear")
+                auto goal = m_goals[i];
+                if (goal.getComponent<CState>().state == "clear")
                 {
                     killPlayer();
                     return;
                 }
 
-                goal->addComponent<CAnimation>(Assets::getInstance().getAnimation("frogIcon"));
-                goal->addComponent<CState>("clear");
+                goal.addComponent<CAnimation>(Assets::getInstance().getAnimation("frogIcon"));
+                goal.addComponent<CState>("clear");
 
                 m_score += static_cast<int>(std::ceil(m_timer.asSeconds())) * 10;
                 m_reachGoal++;
@@ -516,9 +515,9 @@ void Scene_Frogger::resetPlayer()
     position.x /= 2.0f;
     position.y -= 20.f;
 
-    m_player->addComponent<CAnimation>(Assets::getInstance().getAnimation("up"));
-    m_player->addComponent<CTransform>(position);
-    m_player->addComponent<CState>("none");
+    m_player.addComponent<CAnimation>(Assets::getInstance().getAnimation("up"));
+    m_player.addComponent<CTransform>(position);
+    m_player.addComponent<CState>("none");
 
     m_timer = sf::seconds(60);
     m_maxHeight = position.y;
@@ -526,25 +525,25 @@ void Scene_Frogger::resetPlayer()
 
 void Scene_Frogger::killPlayer()
 {
-    if (m_player->hasComponent<CState>() && m_player->getComponent<CState>().state == "dead")
+    if (m_player.hasComponent<CState>() && m_player.getComponent<CState>().state == "dead")
         return;
 
-    auto& lives = m_entityManager.getEntities("lives");
-    lives.back()->destroy();
+    auto lives = m_entityManager.getEntities(Tag::lives);
+    lives.back().destroy();
     m_lives -= 1;
 
-    m_player->addComponent<CAnimation>(Assets::getInstance().getAnimation("die"));
-    m_player->addComponent<CState>("dead");
+    m_player.addComponent<CAnimation>(Assets::getInstance().getAnimation("die"));
+    m_player.addComponent<CState>("dead");
 
     SoundPlayer::getInstance().play("death");
 }
 
 void Scene_Frogger::updateScore()
 {
-    if (m_player->hasComponent<CState>() && m_player->getComponent<CState>().state == "dead")
+    if (m_player.hasComponent<CState>() && m_player.getComponent<CState>().state == "dead")
         return;
 
-    auto& position = m_player->getComponent<CTransform>().pos;
+    auto& position = m_player.getComponent<CTransform>().pos;
 
     if (position.y < m_maxHeight)
     {
@@ -556,44 +555,83 @@ void Scene_Frogger::updateScore()
 }
 
 void Scene_Frogger::sUpdate(sf::Time dt) {
-    SoundPlayer::getInstance().removeStoppedSounds();
+    PROFILE_ZONE("sUpdate");
+
     m_entityManager.update();
 
-    if (m_lives <= 0 || m_reachGoal >= 5)
-        m_game->quitLevel();
+    if (m_lives <= 0 || m_reachGoal >= 5) {
+        m_game->quitLevel(m_levelPath);
+        return;
+    }
 
     if (m_isPaused)
         return;
 
+    // everything spawned by the constructor has been added by now
+    if (m_checkpoint.empty())
+        saveState(m_checkpoint);
+
+    // step back one frame per update while rewind is held
+    m_lanePrevious = m_laneTime;
+    if (m_rewinding) {
+        if (m_rewind.pop(m_frame))
+            loadState(m_frame);
+        return;
+    }
+
     m_timer -= dt;
+    m_laneTime += dt;
 
     if (m_timer.asSeconds() <= 0)
         killPlayer();
 
-    checkPlayerState();
+    m_systems.run(dt);
 
-    sAnimation(dt);
-    sMovement(dt);
-    sCollisions();
+    m_frame.clear();
+    saveState(m_frame);
 
-    updateScore();
+    // the history grows until it reaches its byte budget, then recycles
+    AllocationScope history;
+    m_rewind.push(m_frame);
 }
 
 
-void Scene_Frogger::sAnimation(sf::Time dt) {
-    auto list = m_entityManager.getEntities();
-    for (auto e : m_entityManager.getEntities()) {
-        // update all animations
-        if (e->hasComponent<CAnimation>()) {
-            auto& animation = e->getComponent<CAnimation>().animation;
+void Scene_Frogger::saveState(Snapshot& s) const {
+    SnapshotWriter w(s);
+    m_entityManager.save(w);
+    w.write(m_player);
+    w.write(m_timer);
+    w.write(m_maxHeight);
+    w.write(m_score);
+    w.write(m_lives);
+    w.write(m_reachGoal);
+    w.write(m_laneTime);
+}
 
-            if (e->getTag() == "turtles" && e->getComponent<CState>().state != "animated")
-                continue;
 
-            animation.update(dt);
-            // do nothing if animation has ended
-        }
-    }
+void Scene_Frogger::loadState(const Snapshot& s) {
+    SnapshotReader r(s);
+    m_entityManager.load(r);
+    m_player = r.read<Entity>();
+    m_timer = r.read<sf::Time>();
+    m_maxHeight = r.read<float>();
+    m_score = r.read<int>();
+    m_lives = r.read<int>();
+    m_reachGoal = r.read<int>();
+    m_laneTime = r.read<sf::Time>();
+
+    // the lanes may have gone back, predict again
+    m_safeUntil = sf::Time::Zero;
+}
+
+
+// update all animations
+void Scene_Frogger::sAnimation(sf::Time dt, CommandBuffer&, Entity e, CAnimation& anim) {
+    if (e.getTag() == Tag::turtles && e.getComponent<CState>().state != "animated")
+        return;
+
+    anim.animation.update(dt);
+    // do nothing if animation has ended
 }
 
 
@@ -607,7 +645,7 @@ void Scene_Frogger::adjustPlayerPosition() {
     auto top = center.y - viewHalfSize.y;
     auto bot = center.y + viewHalfSize.y;
 
-    auto& player_pos = m_player->getComponent<CTransform>().pos;
+    auto& player_pos = m_player.getComponent<CTransform>().pos;
     auto halfSize = sf::Vector2f{ 20, 20 };
     // keep player in bounds
     player_pos.x = std::max(player_pos.x, left + halfSize.x);
@@ -618,9 +656,9 @@ void Scene_Frogger::adjustPlayerPosition() {
 
 void Scene_Frogger::checkPlayerState()
 {
-    if (m_player->hasComponent<CState>() && m_player->getComponent<CState>().state == "dead")
+    if (m_player.hasComponent<CState>() && m_player.getComponent<CState>().state == "dead")
     {
-        auto& animation = m_player->getComponent<CAnimation>().animation;
+        auto& animation = m_player.getComponent<CAnimation>().animation;
 
         if (animation.hasEnded())
         {
@@ -644,12 +682,12 @@ void Scene_Frogger::loadLevel(const std::string& path) {
             std::string name;
             sf::Vector2f pos;
             config >> name >> pos.x >> pos.y;
-            auto e = m_entityManager.addEntity("bkg");
+            auto e = m_entityManager.addEntity(Tag::bkg);
 
             // for background, no textureRect its just the whole texture
             // and no center origin, position by top left corner
             // stationary so no CTransfrom required.
-            auto& sprite = e->addComponent<CSprite>(Assets::getInstance().getTexture(name)).sprite;
+            auto& sprite = e.addComponent<CSprite>(Assets::getInstance().getTexture(name)).sprite;
             sprite.setOrigin(0.f, 0.f);
             sprite.setPosition(pos);
         }
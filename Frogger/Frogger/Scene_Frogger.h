@@ -9,6 +9,10 @@
 #include <SFML/Graphics.hpp>
 #include "EntityManager.h"
 #include "Entity.h"
+#include "RewindBuffer.h"
+#include "Lanes.h"
+#include "Physics.h"
+#include "SystemScheduler.h"
 #include "Scene.h"
 #include "GameEngine.h"
 
@@ -16,7 +20,8 @@
 
 class Scene_Frogger : public Scene {
 private:
-    sPtrEntt        m_player{ nullptr };
+    std::string     m_levelPath;
+    Entity          m_player;
     sf::View        m_worldView;
     sf::FloatRect   m_worldBounds;
 
@@ -31,11 +36,31 @@ private:
     int             m_lives;
     int             m_reachGoal;
 
+    // cars, logs and turtles are functions of the lane clock
+    Lanes           m_lanes;
+    sf::Time        m_laneTime{ sf::Time::Zero };
+    sf::Time        m_lanePrevious{ sf::Time::Zero };   // lane clock one update earlier, for blending
+    sf::Vector2f    m_safeAt{ -1.f, -1.f };             // no car reaches the frog here before m_safeUntil
+    sf::Time        m_safeUntil{ sf::Time::Zero };
+
+    // the goals never move, their proxies are made once
+    std::vector<Entity>     m_goals;
+    CollisionProxies        m_goalProxies;
+    std::vector<uint64_t>   m_hits;
+
+    RewindBuffer    m_rewind{ 16 << 20 };
+    Snapshot        m_frame;                // reused every update
+    Snapshot        m_checkpoint;           // level start
+    bool            m_rewinding{ false };
+
+    SystemScheduler m_systems;
+
     //systems
-    void            sMovement(sf::Time dt);
-    void            sCollisions();
+    static void     sMovement(sf::Time dt, CommandBuffer& commands, Entity e, CTransform& tfm);
+    void            sCollisions(sf::Time dt);
     void            sUpdate(sf::Time dt);
-    void            sAnimation(sf::Time dt);
+    static void     sAnimation(sf::Time dt, CommandBuffer& commands, Entity e, CAnimation& anim);
+    void            registerSystems();
 
     void	        onEnd() override;
 
@@ -47,6 +72,7 @@ private:
     void	        registerActions();
     void            spawnPlayer(sf::Vector2f pos);
 
+    EntitySpan      spawnLane(const Prefab& prefab, sf::Vector2f position, sf::Vector2f velocity, float spacing, int count);
     void            spawnLane1();
     void            spawnLane2();
     void            spawnLane3();
@@ -65,6 +91,9 @@ private:
 
     void            updateScore();
 
+    void            saveState(Snapshot& s) const;
+    void            loadState(const Snapshot& s);
+
     void            init(const std::string& path);
     void            loadLevel(const std::string& path);
     sf::FloatRect   getViewBounds();
@@ -75,7 +104,10 @@ public:
 
     void		  update(sf::Time dt) override;
     void		  sDoAction(const Command& command) override;
-    void		  sRender() override;
+    void		  sRender(RenderSnapshot& frame) override;
+    void		  onEnter() override;
+    void		  reset() override;
+    void		  takeTimings(std::vector<ZoneTime>& zones) override;
 
 };
 
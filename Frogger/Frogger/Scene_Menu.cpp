@@ -4,7 +4,7 @@
 
 void Scene_Menu::onEnd()
 {
-	m_game->window().close();
+	m_game->quit();
 }
 
 Scene_Menu::Scene_Menu(GameEngine* gameEngine)
@@ -37,6 +37,10 @@ void Scene_Menu::init()
 	const size_t CHAR_SIZE{ 64 };
 	m_menuText.setCharacterSize(CHAR_SIZE);
 
+	m_footer.setFont(Assets::getInstance().getFont("main"));
+	m_footer.setCharacterSize(20);
+	m_footer.setFillColor(sf::Color(0, 0, 0));
+	m_footer.setPosition(32, 700);
 }
 
 void Scene_Menu::update(sf::Time dt)
@@ -45,40 +49,54 @@ void Scene_Menu::update(sf::Time dt)
 }
 
 
-void Scene_Menu::sRender()
+// build the selected level while the menu is up
+void Scene_Menu::onEnter()
 {
+	preloadSelected();
+}
+
 
-	sf::View view = m_game->window().getView();
-	view.setCenter(m_game->window().getSize().x / 2.f, m_game->window().getSize().y / 2.f);
-	m_game->window().setView(view);
+void Scene_Menu::preloadSelected()
+{
+	auto game = m_game;
+	auto path = m_levelPaths[m_menuIndex];
+	m_game->preloadScene(path, [game, path] { return std::make_shared<Scene_Frogger>(game, path); });
+}
+
+
+// the menu only changes on a key press
+bool Scene_Menu::isIdle() const
+{
+	return true;
+}
+
+
+void Scene_Menu::sRender(RenderSnapshot& frame)
+{
+
+	sf::View view(sf::FloatRect(sf::Vector2f(0.f, 0.f), m_game->windowSize()));
+	view.setCenter(m_game->windowSize().x / 2.f, m_game->windowSize().y / 2.f);
+	frame.view = view;
 
 	static const sf::Color selectedColor(255, 255, 255);
 	static const sf::Color normalColor(0, 0, 0);
 
 	static const sf::Color backgroundColor(100, 100, 255);
 
-	sf::Text footer("UP: W | DOWN: S | PLAY:D | QUIT: ESC",
-		Assets::getInstance().getFont("main"), 20);
-	footer.setFillColor(normalColor);
-	footer.setPosition(32, 700);
-
-	m_game->window().clear(backgroundColor);
+	frame.clearColor = backgroundColor;
 
 	m_menuText.setFillColor(normalColor);
-	m_menuText.setString(m_title);
 	m_menuText.setPosition(10, 10);
-	m_game->window().draw(m_menuText);
+	frame.addText(m_title, m_menuText);
 
 	for (size_t i{ 0 }; i < m_menuStrings.size(); ++i)
 	{
 		m_menuText.setFillColor((i == m_menuIndex ? selectedColor : normalColor));
 		m_menuText.setPosition(32, 32 + (i + 1) * 96);
-		m_menuText.setString(m_menuStrings.at(i));
-		m_game->window().draw(m_menuText);
+		frame.addText(m_menuStrings.at(i), m_menuText);
 	}
 
-	m_game->window().draw(footer);
-	//m_game->window().display();
+	frame.addText("UP: W | DOWN: S | PLAY:D | QUIT: ESC", m_footer);
 
 }
 
@@ -90,14 +108,20 @@ void Scene_Menu::sDoAction(const Command& action)
 		if (action.name() == "UP")
 		{
 			m_menuIndex = (m_menuIndex + m_menuStrings.size() - 1) % m_menuStrings.size();
+			preloadSelected();
 		}
 		else if (action.name() == "DOWN")
 		{
 			m_menuIndex = (m_menuIndex + 1) % m_menuStrings.size();
+			preloadSelected();
 		}
 		else if (action.name() == "PLAY")
 		{
-			m_game->changeScene("PLAY", std::make_shared<Scene_Frogger>(m_game, m_levelPaths[m_menuIndex]));
+			const auto& path = m_levelPaths[m_menuIndex];
+			auto level = m_game->takeScene(path);
+			if (!level)
+				level = std::make_shared<Scene_Frogger>(m_game, path);
+			m_game->pushScene(level);
 		}
 		else if (action.name() == "QUIT")
 		{
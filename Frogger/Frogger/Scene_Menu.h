@@ -7,6 +7,7 @@ class Scene_Menu : public Scene
 private:
 	std::vector<std::string>	m_menuStrings;
 	sf::Text					m_menuText;
+	sf::Text					m_footer;
 	std::vector<std::string>	m_levelPaths;
 	int							m_menuIndex{ 0 };
 	std::string					m_title;
@@ -14,13 +15,16 @@ private:
 
 	void init();
 	void onEnd() override;
+	void preloadSelected();
 public:
 
 	Scene_Menu(GameEngine* gameEngine);
 
 	void update(sf::Time dt) override;
 
-	void sRender() override;
+	void sRender(RenderSnapshot& frame) override;
+	bool isIdle() const override;
+	void onEnter() override;
 	void sDoAction(const Command& action) override;
 
 
@@ -0,0 +1,74 @@
+#include "Snapshot.h"
+
+
+namespace {
+    void saveSprite(SnapshotWriter& w, const sf::Sprite& sprite) {
+        w.write(sprite.getTexture());
+        w.write(sprite.getTextureRect());
+        w.write(sprite.getColor());
+        w.write(sprite.getOrigin());
+        w.write(sprite.getPosition());
+        w.write(sprite.getRotation());
+        w.write(sprite.getScale());
+    }
+
+
+    void loadSprite(SnapshotReader& r, sf::Sprite& sprite) {
+        if (auto texture = r.read<const sf::Texture*>())
+            sprite.setTexture(*texture);
+        sprite.setTextureRect(r.read<sf::IntRect>());
+        sprite.setColor(r.read<sf::Color>());
+        sprite.setOrigin(r.read<sf::Vector2f>());
+        sprite.setPosition(r.read<sf::Vector2f>());
+        sprite.setRotation(r.read<float>());
+        sprite.setScale(r.read<sf::Vector2f>());
+    }
+}
+
+
+void saveComponent(SnapshotWriter& w, const CSprite& c) {
+    saveSprite(w, c.sprite);
+}
+
+
+void loadComponent(SnapshotReader& r, CSprite& c) {
+    loadSprite(r, c.sprite);
+}
+
+
+void saveComponent(SnapshotWriter& w, const CAnimation& c) {
+    auto& anim = c.animation;
+    w.writeString(anim.m_name);
+    w.write(anim.m_frames.data());
+    w.write(anim.m_frames.size());
+    w.write(anim.m_timePerFrame);
+    w.write(anim.m_currentFrame);
+    w.write(anim.m_countDown);
+    w.write(anim.m_isRepeating);
+    w.write(anim.m_hasEnded);
+    w.write(anim.m_texture);
+}
+
+
+void loadComponent(SnapshotReader& r, CAnimation& c) {
+    auto& anim = c.animation;
+    anim.m_name = r.readString();
+    auto frames = r.read<const sf::IntRect*>();
+    anim.m_frames = std::span<const sf::IntRect>(frames, r.read<size_t>());
+    anim.m_timePerFrame = r.read<sf::Time>();
+    anim.m_currentFrame = r.read<size_t>();
+    anim.m_countDown = r.read<sf::Time>();
+    anim.m_isRepeating = r.read<bool>();
+    anim.m_hasEnded = r.read<bool>();
+    anim.m_texture = r.read<const sf::Texture*>();
+}
+
+
+void saveComponent(SnapshotWriter& w, const CState& c) {
+    w.writeString(c.state);
+}
+
+
+void loadComponent(SnapshotReader& r, CState& c) {
+    c.state = r.readString();
+}
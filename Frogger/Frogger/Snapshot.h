@@ -0,0 +1,111 @@
+#ifndef BREAKOUT_SNAPSHOT_H
+#define BREAKOUT_SNAPSHOT_H
+
+
+#include <vector>
+#include <string>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <cassert>
+#include <type_traits>
+
+#include "Components.h"
+
+
+// World state as one flat byte blob. Trivially copyable data is copied as
+// raw bytes, components that hold SFML objects go through the codecs
+// below. Texture pointers are stored as they are, so a blob is only valid
+// in the process that wrote it.
+using Snapshot = std::vector<std::byte>;
+
+
+class SnapshotWriter {
+private:
+    Snapshot&               m_blob;
+
+public:
+    explicit SnapshotWriter(Snapshot& blob) : m_blob(blob) {}
+
+    void writeBytes(const void* data, size_t n) {
+        auto bytes = static_cast<const std::byte*>(data);
+        m_blob.insert(m_blob.end(), bytes, bytes + n);
+    }
+
+
+    template<typename T>
+    void write(const T& value) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        writeBytes(&value, sizeof(T));
+    }
+
+
+    template<typename T>
+    void writeArray(const std::vector<T>& values) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        write(static_cast<uint32_t>(values.size()));
+        writeBytes(values.data(), values.size() * sizeof(T));
+    }
+
+
+    void writeString(const std::string& s) {
+        write(static_cast<uint32_t>(s.size()));
+        writeBytes(s.data(), s.size());
+    }
+};
+
+
+class SnapshotReader {
+private:
+    const std::byte*        m_pos;
+    const std::byte*        m_end;
+
+public:
+    explicit SnapshotReader(const Snapshot& blob)
+        : m_pos(blob.data()), m_end(blob.data() + blob.size()) {}
+
+    void readBytes(void* out, size_t n) {
+        assert(n <= static_cast<size_t>(m_end - m_pos));
+        if (n == 0)
+            return;
+        std::memcpy(out, m_pos, n);
+        m_pos += n;
+    }
+
+
+    template<typename T>
+    T read() {
+        static_assert(std::is_trivially_copyable_v<T>);
+        T value;
+        readBytes(&value, sizeof(T));
+        return value;
+    }
+
+
+    template<typename T>
+    void readArray(std::vector<T>& values) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        values.resize(read<uint32_t>());
+        readBytes(values.data(), values.size() * sizeof(T));
+    }
+
+
+    std::string readString() {
+        std::string s(read<uint32_t>(), '\0');
+        readBytes(s.data(), s.size());
+        return s;
+    }
+};
+
+
+// codecs for the components that are not trivially copyable,
+// ComponentPool picks them up by overload
+void saveComponent(SnapshotWriter& w, const CSprite& c);
+void loadComponent(SnapshotReader& r, CSprite& c);
+void saveComponent(SnapshotWriter& w, const CAnimation& c);
+void loadComponent(SnapshotReader& r, CAnimation& c);
+void saveComponent(SnapshotWriter& w, const CState& c);
+void loadComponent(SnapshotReader& r, CState& c);
+
+
+#endif //BREAKOUT_SNAPSHOT_H
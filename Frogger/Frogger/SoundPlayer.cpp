@@ -7,6 +7,7 @@
 
 #include <SFML/System/Vector2.hpp>
 #include <SFML/Audio/Listener.hpp>
+#include <algorithm>
 #include <cassert>
 #include <cmath>
 #include <stdexcept>
@@ -20,15 +21,27 @@ namespace {
     const float Attenuation = 1.f;
     const float MinDistance2D = 200.f;
     const float MinDistance3D = std::sqrt(MinDistance2D * MinDistance2D + ListenerZ * ListenerZ);
+
+    bool nullBackend{ false };
 }
 
 
-SoundPlayer::SoundPlayer() {
+SoundPlayer::SoundPlayer() : m_null(nullBackend) {
+    if (m_null)
+        return;
+
+    m_voices.resize(MAX_VOICES);
+
     // Listener points towards the screen (default in SFML)
     sf::Listener::setDirection(0.f, 0.f, -1.f);
 }
 
 
+void SoundPlayer::useNullBackend() {
+    nullBackend = true;
+}
+
+
 SoundPlayer& SoundPlayer::getInstance() {
     static SoundPlayer instance;
     return instance;
@@ -41,8 +54,19 @@ void SoundPlayer::play(String effect) {
 
 
 void SoundPlayer::play(String effect, sf::Vector2f position) {
-    m_sounds.push_back(sf::Sound());
-    sf::Sound& sound = m_sounds.back();
+    if (m_null)
+        return;
+
+    // a free voice, or else the one that has been playing longest
+    auto free = std::find_if(m_voices.begin(), m_voices.end(), [](const sf::Sound& s) {
+        return s.getStatus() == sf::Sound::Stopped;
+        });
+    if (free == m_voices.end()) {
+        free = m_voices.begin() + m_next;
+        free->stop();
+    }
+    m_next = (free - m_voices.begin() + 1) % m_voices.size();
+    sf::Sound& sound = *free;
 
     sound.setBuffer(Assets::getInstance().getSound(effect));
 
@@ -54,30 +78,38 @@ void SoundPlayer::play(String effect, sf::Vector2f position) {
 }
 
 
-void SoundPlayer::removeStoppedSounds() {
-    m_sounds.remove_if([](const sf::Sound& s) {
-        return s.getStatus() == sf::Sound::Stopped;
-        });
-}
-
-
 void SoundPlayer::setListnerPosition(sf::Vector2f position) {
+    if (m_null)
+        return;
     sf::Listener::setPosition(position.x, -position.y, ListenerZ);
 }
 
 
 void SoundPlayer::setListnerDirection(sf::Vector2f position) {
+    if (m_null)
+        return;
+
     // SFML default listner direction is (0,0,-1)
     sf::Listener::setDirection(position.x, 0, -position.y);
 }
 
 sf::Vector2f SoundPlayer::getListnerPosition() const {
+    if (m_null)
+        return sf::Vector2f(0.f, 0.f);
+
     sf::Vector3f pos = sf::Listener::getPosition();
     return sf::Vector2f(pos.x, -pos.y);
 }
 
 
 bool SoundPlayer::isEmpty() const {
-    return m_sounds.empty();
+    return voices() == 0;
+}
+
+
+size_t SoundPlayer::voices() const {
+    return std::count_if(m_voices.begin(), m_voices.end(), [](const sf::Sound& s) {
+        return s.getStatus() != sf::Sound::Stopped;
+        });
 }
 
@@ -11,7 +11,7 @@
 #include <SFML/System/Vector2.hpp>
 
 #include <map>
-#include <list>
+#include <vector>
 #include <string>
 #include <memory>
 
@@ -21,12 +21,20 @@ class SoundPlayer {
 protected:
     SoundPlayer();
 
+public:
+    static constexpr size_t MAX_VOICES{ 32 };
+
 private:
-    std::list<sf::Sound>                                m_sounds;
+    std::vector<sf::Sound>                              m_voices;   // MAX_VOICES, reused so play() never allocates
+    size_t                                              m_next{ 0 };    // the voice to steal when all are busy
+    const bool                                          m_null;     // no audio device, every call is a no-op
 
 public:
     static SoundPlayer& getInstance();
 
+    // call before the first getInstance(), for machines without audio
+    static void         useNullBackend();
+
     // no copy/move for singelton
     SoundPlayer(const SoundPlayer&) = delete;
     SoundPlayer(SoundPlayer&&) = delete;
@@ -36,12 +44,12 @@ public:
 public:
     void			    play(String effect);
     void			    play(String effect, sf::Vector2f position);
-    void			    removeStoppedSounds();
     void			    setListnerPosition(sf::Vector2f position);
     void			    setListnerDirection(sf::Vector2f position);
     sf::Vector2f	    getListnerPosition() const;
 
     bool                isEmpty() const;
+    size_t              voices() const;     // sounds playing
 };
 
 
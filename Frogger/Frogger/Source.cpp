@@ -20,13 +20,30 @@
 
 
 #include <iostream>
+#include <string>
 #include "GameEngine.h"
 
 
 
-int main()
+// Frogger [--speed n]                      play, n updates per fixed step
+// Frogger --headless [ticks] [level]       no window or audio, prints ticks per second
+int main(int argc, char* argv[])
 {
+    const std::string mode = argc > 1 ? argv[1] : "";
+
+    if (mode == "--headless")
+    {
+        const int ticks = argc > 2 ? std::stoi(argv[2]) : 10000;
+        const std::string level = argc > 3 ? argv[3] : "../assets/level1.txt";
+
+        GameEngine game("../config.txt", true);
+        game.runHeadless(ticks, level);
+        return 0;
+    }
+
     GameEngine game("../config.txt");
+    if (mode == "--speed" && argc > 2)
+        game.setSimulationSpeed(std::stoul(argv[2]));
     game.run();
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,113 @@
+#include "SystemScheduler.h"
+#include <algorithm>
+#include <cassert>
+
+
+SystemScheduler::SystemScheduler(EntityManager& entityManager)
+    : m_entityManager(entityManager) {}
+
+
+void SystemScheduler::addSystem(System system) {
+    assert(std::none_of(m_systems.begin(), m_systems.end(),
+        [&](const System& s) { return s.name == system.name; }));
+    system.zone = Profiler::getInstance().intern(system.name);
+    m_systems.push_back(std::move(system));
+}
+
+
+void SystemScheduler::addExclusive(const std::string& name, SystemFn fn) {
+    System system;
+    system.name = name;
+    system.exclusive = true;
+    system.prepare = [] { return size_t{ 1 }; };
+    system.run = [fn = std::move(fn)](sf::Time dt, size_t, size_t, CommandBuffer&) { fn(dt); };
+    addSystem(std::move(system));
+}
+
+
+void SystemScheduler::setEnabled(const std::string& name, bool enabled) {
+    for (auto& system : m_systems)
+        if (system.name == name)
+            system.enabled = enabled;
+}
+
+
+bool SystemScheduler::conflicts(const System& a, const System& b) {
+    return a.exclusive || b.exclusive
+        || (a.writes & (b.reads | b.writes)) != 0
+        || (b.writes & a.reads) != 0;
+}
+
+
+void SystemScheduler::run(sf::Time dt) {
+    // dependency graph: a system goes one level after the latest earlier
+    // system it conflicts with, systems on the same level never conflict
+    auto& level = m_level;
+    level.assign(m_systems.size(), 0);
+    size_t levels{ 0 };
+    for (size_t i{ 0 }; i < m_systems.size(); ++i) {
+        if (!m_systems[i].enabled)
+            continue;
+        for (size_t j{ 0 }; j < i; ++j)
+            if (m_systems[j].enabled && conflicts(m_systems[j], m_systems[i]))
+                level[i] = std::max(level[i], level[j] + 1);
+        levels = std::max(levels, level[i] + 1);
+    }
+
+    // streams are handed out in registration and chunk order, so playback
+    // is the same whatever thread finishes first. Stream 0 is left to code
+    // outside the scheduler.
+    size_t stream{ 1 };
+    for (size_t l{ 0 }; l < levels; ++l) {
+        m_tasks.clear();
+        size_t items{ 0 };
+        for (size_t i{ 0 }; i < m_systems.size(); ++i) {
+            auto& system = m_systems[i];
+            if (!system.enabled || level[i] != l)
+                continue;
+
+            if (system.exclusive) {
+                PROFILE_ZONE(system.zone);
+                const auto start = Clock::now();
+                system.run(dt, 0, 1, m_entityManager.commands(stream++));
+                system.ns += (Clock::now() - start).count();
+                continue;
+            }
+
+            const size_t n = system.prepare();
+            items += n;
+            for (size_t first{ 0 }; first < n; first += m_chunkSize) {
+                const size_t last = std::min(n, first + m_chunkSize);
+                m_tasks.push_back(Task{ &system, first, last, &m_entityManager.commands(stream++) });
+            }
+        }
+
+        // each task times itself, the system totals are summed once the level is done
+        auto runTasks = [this, dt](size_t first, size_t last) {
+            for (size_t t{ first }; t < last; ++t) {
+                auto& task = m_tasks[t];
+                PROFILE_ZONE(task.system->zone);
+                const auto start = Clock::now();
+                task.system->run(dt, task.first, task.last, *task.commands);
+                task.ns = (Clock::now() - start).count();
+            }
+            };
+
+        // less than a chunk of work all told is cheaper here than in jobs
+        if (items <= m_chunkSize)
+            runTasks(0, m_tasks.size());
+        else
+            JobSystem::getInstance().parallelFor(0, m_tasks.size(), 1, runTasks);
+        for (const auto& task : m_tasks)
+            task.system->ns += task.ns;
+    }
+}
+
+
+void SystemScheduler::takeTimings(std::vector<ZoneTime>& zones) {
+    for (auto& system : m_systems) {
+        if (system.ns > 0)
+            zones.push_back(ZoneTime{ system.zone, std::chrono::duration<float, std::milli>(Clock::duration(system.ns)).count() });
+        system.ns = 0;
+    }
+}
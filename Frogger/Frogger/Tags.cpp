@@ -0,0 +1,52 @@
+#include "Tags.h"
+#include <cassert>
+
+
+namespace {
+    // must match the order of the Tag enum
+    const char* const builtinTags[Tag::Count] = {
+        "Default",
+        "bkg",
+        "player",
+        "car",
+        "turtles",
+        "tree",
+        "goal",
+        "lives",
+    };
+}
+
+
+TagRegistry::TagRegistry() {
+    for (auto name : builtinTags)
+        intern(name);
+}
+
+
+TagRegistry& TagRegistry::getInstance() {
+    static TagRegistry instance; // Meyers Singleton implementation
+    return instance;
+}
+
+
+TagId TagRegistry::intern(const std::string& name) {
+    auto found = m_ids.find(name);
+    if (found != m_ids.end())
+        return found->second;
+
+    assert(m_names.size() < UINT16_MAX);
+    auto id = static_cast<TagId>(m_names.size());
+    m_names.push_back(name);
+    m_ids[name] = id;
+    return id;
+}
+
+
+const std::string& TagRegistry::getName(TagId id) const {
+    return m_names.at(id);
+}
+
+
+size_t TagRegistry::size() const {
+    return m_names.size();
+}
@@ -0,0 +1,82 @@
+#include "CommandBuffer.h"
+#include "EntityManager.h"
+#include "MemoryTracker.h"
+#include <algorithm>
+
+
+CommandBuffer::~CommandBuffer() {
+    // never played back, the payloads still need destroying
+    for (auto& cmd : m_commands)
+        if (cmd.op == Op::Apply)
+            cmd.apply(cmd.payload, nullptr);
+}
+
+
+CommandBuffer::Spawned CommandBuffer::spawn(TagId tag) {
+    append(Command{ Op::Spawn, Entity(), m_spawnCount, tag });
+    return Spawned{ m_spawnCount++ };
+}
+
+
+void CommandBuffer::destroy(Entity e) {
+    append(Command{ Op::Destroy, e, NO_SPAWN, Tag::Default });
+}
+
+
+void CommandBuffer::append(const Command& cmd) {
+    if (m_commands.size() == m_commands.capacity()) {
+        AllocationScope growth;
+        m_commands.reserve(std::max<size_t>(64, 2 * m_commands.size()));
+    }
+    m_commands.push_back(cmd);
+}
+
+
+// bump allocation in the current block, a new block once it is full;
+// blocks are only freed with the buffer
+void* CommandBuffer::allocate(size_t size, size_t align) {
+    size_t offset = (m_used + align - 1) & ~(align - 1);
+    if (m_block == 0 || offset + size > BLOCK_SIZE) {
+        if (m_block == m_blocks.size()) {
+            AllocationScope growth;
+            m_blocks.push_back(std::unique_ptr<std::byte[]>(new std::byte[BLOCK_SIZE]));
+        }
+        ++m_block;
+        offset = 0;
+    }
+    m_used = offset + size;
+    return m_blocks[m_block - 1].get() + offset;
+}
+
+
+void CommandBuffer::playback(EntityManager& manager) {
+    if (m_spawned.capacity() < m_spawnCount) {
+        AllocationScope growth;
+        m_spawned.reserve(2 * m_spawnCount);
+    }
+    m_spawned.assign(m_spawnCount, Entity());
+
+    for (auto& cmd : m_commands) {
+        Entity target = cmd.spawned == NO_SPAWN ? cmd.target : m_spawned[cmd.spawned];
+
+        switch (cmd.op) {
+        case Op::Spawn:
+            m_spawned[cmd.spawned] = manager.addEntity(cmd.tag);
+            break;
+
+        case Op::Destroy:
+            target.destroy();
+            break;
+
+        case Op::Apply:
+            // the entity may have been removed since the command was recorded
+            cmd.apply(cmd.payload, target.isValid() ? &target : nullptr);
+            break;
+        }
+    }
+
+    m_commands.clear();
+    m_spawnCount = 0;
+    m_block = 0;
+    m_used = 0;
+}
\ No newline at end of file
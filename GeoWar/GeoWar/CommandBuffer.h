@@ -0,0 +1,124 @@
+#ifndef GEOWARS_COMMANDBUFFER_H
+#define GEOWARS_COMMANDBUFFER_H
+
+
+#include <vector>
+#include <memory>
+#include <new>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+#include "Entity.h"
+#include "Tags.h"
+
+
+// Records structural changes (spawn, destroy, add/remove component) so a
+// system can run off the main thread without touching EntityManager.
+// Each thread records into its own buffer, EntityManager::update() plays
+// the buffers back in stream order so the result does not depend on
+// which thread finished first.
+//
+// What a command applies is stored in blocks the buffer keeps between
+// playbacks, so once they and the command list have grown to the busiest
+// update recording does not allocate. Growing is allowed under
+// ASSERT_NO_ALLOCATIONS, it is paid once per doubling.
+class CommandBuffer {
+public:
+    // an entity spawned by this buffer, only usable with this buffer
+    // until it is played back
+    struct Spawned {
+        uint32_t            idx;
+    };
+
+private:
+    friend class EntityManager;
+
+    enum class Op : uint8_t { Spawn, Destroy, Apply };
+
+    // applies the payload to target and destroys it, a null target only destroys it
+    using ApplyFn = void (*)(void* payload, Entity* target);
+
+    struct Command {
+        Op                  op;
+        Entity              target;                 // Destroy/Apply on an existing entity
+        uint32_t            spawned{ NO_SPAWN };    // Apply on an entity spawned by this buffer
+        TagId               tag{ Tag::Default };    // Spawn
+        void*               payload{ nullptr };     // Apply, in one of m_blocks
+        ApplyFn             apply{ nullptr };
+    };
+
+    static constexpr uint32_t NO_SPAWN{ UINT32_MAX };
+    static constexpr size_t BLOCK_SIZE{ 4096 };
+
+    std::vector<Command>    m_commands;
+    uint32_t                m_spawnCount{ 0 };
+    std::vector<Entity>     m_spawned;              // by spawn index, during playback
+    std::vector<std::unique_ptr<std::byte[]>> m_blocks;
+    size_t                  m_block{ 0 };           // blocks in use, the last one partly
+    size_t                  m_used{ 0 };            // bytes used in the last block in use
+
+    void                    append(const Command& cmd);
+    void*                   allocate(size_t size, size_t align);
+    template<typename F>
+    void                    record(Entity target, uint32_t spawned, F apply);
+    void                    playback(EntityManager& manager);
+
+public:
+    CommandBuffer() = default;
+    ~CommandBuffer();
+
+    CommandBuffer(const CommandBuffer&) = delete;
+    CommandBuffer& operator=(const CommandBuffer&) = delete;
+
+    Spawned                 spawn(TagId tag);
+    void                    destroy(Entity e);
+    bool                    empty() const { return m_commands.empty(); }
+    size_t                  size() const { return m_commands.size(); }
+
+
+    template<typename T, typename... TArgs>
+    void addComponent(Entity e, TArgs &&... mArgs) {
+        record(e, NO_SPAWN, [c = T(std::forward<TArgs>(mArgs)...)](Entity target) mutable {
+            target.addComponent<T>(std::move(c));
+            });
+    }
+
+
+    template<typename T, typename... TArgs>
+    void addComponent(Spawned s, TArgs &&... mArgs) {
+        record(Entity(), s.idx, [c = T(std::forward<TArgs>(mArgs)...)](Entity target) mutable {
+            target.addComponent<T>(std::move(c));
+            });
+    }
+
+
+    template<typename T>
+    void removeComponent(Entity e) {
+        record(e, NO_SPAWN, [](Entity target) { target.removeComponent<T>(); });
+    }
+
+
+    template<typename T>
+    void removeComponent(Spawned s) {
+        record(Entity(), s.idx, [](Entity target) { target.removeComponent<T>(); });
+    }
+};
+
+
+template<typename F>
+void CommandBuffer::record(Entity target, uint32_t spawned, F apply) {
+    static_assert(sizeof(F) <= BLOCK_SIZE && alignof(F) <= alignof(std::max_align_t),
+        "command does not fit in a block");
+    void* payload = new (allocate(sizeof(F), alignof(F))) F(std::move(apply));
+    append(Command{ Op::Apply, target, spawned, Tag::Default, payload,
+        [](void* p, Entity* e) {
+            F& f = *static_cast<F*>(p);
+            if (e)
+                f(*e);
+            f.~F();
+        } });
+}
+
+
+#endif //GEOWARS_COMMANDBUFFER_H
\ No newline at end of file
@@ -2,6 +2,8 @@
 #define GEOWARS_COMPONENTS_H
 
 #include <memory>
+#include <tuple>
+#include <array>
 #include <SFML/Graphics.hpp>
 #include "Utilities.h"
 
@@ -13,21 +15,21 @@ struct Component
 };
 
 
+// a regular polygon around the transform, plain data so spawning, copying
+// and snapshots never touch SFML; draw() builds the sf::CircleShape
 struct CShape : public Component
 {
-    sf::CircleShape circle;
+    float       radius{ 0.f };
+    size_t      pointCount{ 30 };
+    sf::Color   fill;
+    sf::Color   outline{ sf::Color::Black };
+    float       thickness{ 5.f };
 
     CShape() = default;
 
 
     CShape(float r, size_t points, const sf::Color& fill, const sf::Color& outline = sf::Color::Black, float thickness = 5.f)
-        : circle(r, points)
-    {
-        circle.setFillColor(fill);
-        circle.setOutlineColor(outline);
-        circle.setOutlineThickness(thickness);
-        circle.setOrigin(r, r);
-    }
+        : radius(r), pointCount(points), fill(fill), outline(outline), thickness(thickness) {}
 };
 
 
@@ -65,6 +67,7 @@ struct CScore : public Component
 struct CTransform : public Component
 {
     sf::Vector2f        pos{ 0.f, 0.f };
+    sf::Vector2f        prevPos{ 0.f, 0.f };  // pos one update earlier
     sf::Vector2f		vel{ 0.f, 0.f };
 
     float               rot{ 0 };   // degrees
@@ -73,7 +76,7 @@ struct CTransform : public Component
     CTransform() = default;
 
     CTransform(sf::Vector2f p, sf::Vector2f v, float rs = 60.f)
-        : pos(p), vel(v), rotSpeed(rs) {}
+        : pos(p), prevPos(p), vel(v), rotSpeed(rs) {}
 };
 
 
@@ -88,6 +91,14 @@ struct CLifespan : public Component
 };
 
 
+// every component type, EntityManager keeps one pool per entry
+using ComponentTuple = std::tuple<CShape, CInput, CCollision, CTransform, CLifespan, CScore>;
+
+// for reports, in ComponentTuple order
+inline constexpr std::array<const char*, std::tuple_size_v<ComponentTuple>> COMPONENT_NAMES{
+    "CShape", "CInput", "CCollision", "CTransform", "CLifespan", "CScore" };
+
+
 
 
 #endif //GEOWARS_COMPONENTS_H
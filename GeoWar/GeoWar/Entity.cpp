@@ -1,25 +1,34 @@
 #include "Entity.h"
+#include "EntityManager.h"
 
+Entity::Entity(EntityManager* manager, uint32_t index, uint32_t generation)
+    : m_manager(manager), m_handle((generation << INDEX_BITS) | index) {
 
-Entity::Entity(size_t id, const std::string& tag)
-    : m_id(id), m_tag(tag) {}
-
-
-void Entity::destroy() {
-    m_active = false;
 }
 
-
-const size_t& Entity::getId() const {
-    return m_id;
+void Entity::destroy() const {
+    if (isActive()) {
+        m_manager->m_slots[index()].active = false;
+        m_manager->m_dead.push_back(index());
+    }
 }
 
+size_t Entity::getId() const {
+    return m_manager->m_slots[index()].id;
+}
 
-const std::string& Entity::getTag() const {
-    return m_tag;
+TagId Entity::getTag() const {
+    return m_manager->m_slots[index()].tag;
 }
 
+const std::string& Entity::getTagName() const {
+    return TagRegistry::getInstance().getName(getTag());
+}
 
 bool Entity::isActive() const {
-    return m_active;
+    return isValid() && m_manager->m_slots[index()].active;
+}
+
+bool Entity::isValid() const {
+    return m_manager != nullptr && m_manager->m_slots[index()].generation == generation();
 }
\ No newline at end of file
@@ -1,65 +1,65 @@
 #ifndef GEOWARS_ENTITY_H
 #define GEOWARS_ENTITY_H
 
-#include <tuple>
+
+#include <string>
+#include <cstdint>
+
 #include "Components.h"
+#include "Tags.h"
 // forward declarations
 class EntityManager;
 
-using ComponentTuple = std::tuple<CShape, CInput, CCollision, CTransform, CLifespan, CScore>;
 
+// Entities are cheap value handles, copy them freely.
+// The 32 bit handle packs the slot index in the low bits and the slot's
+// generation in the high bits, once the slot is reused by another entity
+// the generation no longer matches and the old handle reads as invalid.
 class Entity {
+public:
+    static constexpr uint32_t   INDEX_BITS{ 20 };
+    static constexpr uint32_t   INDEX_MASK{ (1u << INDEX_BITS) - 1 };
+    static constexpr uint32_t   GENERATION_MASK{ (1u << (32 - INDEX_BITS)) - 1 };
+
 private:
     friend class EntityManager;
-    Entity(size_t id, const std::string& tag);      // private ctor, create entities with EntityManager
+    Entity(EntityManager* manager, uint32_t index, uint32_t generation);      // create entities with EntityManager
 
-    const size_t            m_id{ 0 };
-    const std::string       m_tag{ "Default" };
-    bool                    m_active{ true };
-    ComponentTuple          m_components;
+    EntityManager*          m_manager{ nullptr };
+    uint32_t                m_handle{ 0 };
 
 public:
+    Entity() = default;     // null handle, never valid
 
-    void                    destroy();
-    const size_t& getId() const;
-    const std::string& getTag() const;
+    void                    destroy() const;
+    size_t                  getId() const;
+    TagId                   getTag() const;
+    const std::string&      getTagName() const;
     bool                    isActive() const;
+    bool                    isValid() const;
 
+    uint32_t                index() const { return m_handle & INDEX_MASK; }
+    uint32_t                generation() const { return m_handle >> INDEX_BITS; }
 
+    bool                    operator==(const Entity& other) const = default;
 
-    // Component API
-    template<typename T>
-    inline bool hasComponent() const {
-        return getComponent<T>().has;
-    }
 
+    // Component API, defined in EntityManager.h
+    template<typename T>
+    bool hasComponent() const;
 
     template<typename T, typename... TArgs>
-    inline T& addComponent(TArgs &&... mArgs) {
-        auto& component = getComponent<T>();
-        component = T(std::forward<TArgs>(mArgs)...);
-        component.has = true;
-        return component;
-    }
-
+    T& addComponent(TArgs &&... mArgs) const;
 
     template<typename T>
-    inline bool removeComponent() const {
-        return getComponent<T>().has = false;
-    }
-
+    bool removeComponent() const;
 
     template<typename T>
-    inline T& getComponent() {
-        return std::get<T>(m_components);
-    }
+    T& getComponent() const;
+};
 
 
-    template<typename T>
-    inline const T& getComponent() const {
-        return std::get<T>(m_components);
-    }
-};
+#include "EntityManager.h"
 
 
-#endif //GEOWARS_ENTITY_H
+#endif //GEOWARS_ENTITY_H
\ No newline at end of file
@@ -1,33 +1,71 @@
 #include "Game.h"
+#include "Physics.h"
 #include <fstream>
 #include <iostream>
 #include <SFML/Graphics.hpp>
 #include "Utilities.h"
+#include "JobSystem.h"
+#include "MemoryTracker.h"
 #include <random>
+#include <thread>
+#include <chrono>
+#include <sstream>
+#include <iomanip>
+#include <array>
+#include <charconv>
 
 
 namespace {
 	std::random_device rd;
 	std::mt19937 rng(rd());
+
+	const int WARM_UP_FRAMES = 120;		// until pools and buffers have grown
 }
 
 
-const sf::Time Game::TIME_PER_FRAME = sf::seconds((1.f / 60.f));
 
 
-Game::Game(const std::string& path) {
+Game::Game(const std::string& path, bool headless) {
 
 	// load the game configuration from file "path"
 	loadConfigFromFile(path);
 
 	// now that you have the config loaded you can create the RenderWindow
-	m_window.create(sf::VideoMode(m_windowSize.x, m_windowSize.y), "GEX Engine");
+	if (headless)
+		m_view = sf::View(sf::FloatRect(0.f, 0.f, static_cast<float>(m_windowSize.x), static_cast<float>(m_windowSize.y)));
+	else {
+		m_window.create(sf::VideoMode(m_windowSize.x, m_windowSize.y), "GEX Engine");
+		m_view = m_window.getDefaultView();
+	}
 
 	// set up stats text to display FPS
 	m_statisticsText.setFont(m_font);
 	m_statisticsText.setPosition(15.0f, 15.0f);
 	m_statisticsText.setCharacterSize(15);
 
+	m_scoreText.setFont(m_font);
+	m_scoreText.setPosition(5, 30);
+
+	// bullets only differ in where they start and where they go
+	m_bulletPrefab = m_entityManager.definePrefab(Prefab(Tag::bullet)
+		.set<CShape>(
+			m_bulletConfig.SR,
+			m_bulletConfig.V,
+			sf::Color(m_bulletConfig.FR, m_bulletConfig.FG, m_bulletConfig.FB),
+			sf::Color(m_bulletConfig.OR, m_bulletConfig.OG, m_bulletConfig.OB),
+			m_bulletConfig.OT)
+		.set<CCollision>(m_bulletConfig.CR)
+		.set<CTransform>(sf::Vector2f(), sf::Vector2f())
+		.set<CLifespan>(m_bulletConfig.L));
+
+	// explosion fragments expire together, repack the pools when half the world dies at once
+	m_entityManager.setCompactionRatio(0.5f);
+
+	// a burst is one fragment per vertex
+	m_burst.reserve(m_enemyConfig.VMAX);
+
+	registerSystems();
+
 	// spawn the player
 	spawnPlayer();
 }
@@ -42,17 +80,19 @@ void Game::sUserInput() {
 	//    * pause/un-pause the game on Escape keypress
 	//    * quit the game on  Q keypress
 
-	if (!m_isPaused) {
+	// the main thread polls the window, the events are handled here on the simulation thread
+	// the two buffers trade places, both keep their capacity
+	m_events.clear();
+	{
+		std::lock_guard<std::mutex> lock(m_inputMutex);
+		m_events.swap(m_input);
+	}
 
-		auto& uInput = m_player->getComponent<CInput>();
+	if (!m_isPaused) {
 
-		sf::Event event;
-		while (m_window.pollEvent(event)) {
-			if (event.type == sf::Event::Closed) {
-				m_window.close();
-				m_isRunning = false;
-			}
+		auto& uInput = m_player.getComponent<CInput>();
 
+		for (const auto& event : m_events) {
 
 			// TODO handle key press events
 			if (event.type == sf::Event::KeyPressed) {
@@ -90,6 +130,14 @@ void Game::sUserInput() {
 					m_drawBB = !m_drawBB;
 					break;
 
+				case sf::Keyboard::R:
+					m_rewinding = true;
+					break;
+
+				case sf::Keyboard::Backspace:
+					m_restart = true;
+					break;
+
 				default:
 					break;
 				}
@@ -120,6 +168,10 @@ void Game::sUserInput() {
 					uInput.right = false;
 					break;
 
+				case sf::Keyboard::R:
+					m_rewinding = false;
+					break;
+
 				default:
 					break;
 				}
@@ -140,13 +192,7 @@ void Game::sUserInput() {
 		}
 	}
 	else {
-		sf::Event event;
-		while (m_window.pollEvent(event)) {
-			if (event.type == sf::Event::Closed) {
-				m_window.close();
-				m_isRunning = false;
-			}
-
+		for (const auto& event : m_events) {
 			if (event.type == sf::Event::KeyPressed) {
 				switch (event.key.code) {
 
@@ -175,23 +221,79 @@ void Game::sUpdate(sf::Time dt) {
 
 
 	// TODO spawn a new player if player was destroyed
-	if (!m_player->isActive())
-		m_player.reset();
-
+	// update() removes a destroyed player, which leaves the handle invalid
 	m_entityManager.update();
 
-	if (m_player == nullptr)
+	// the player spawned by the constructor has been added by now
+	if (m_checkpoint.empty()) {
+		AllocationScope checkpoint;
+		saveState(m_checkpoint);
+	}
+
+	if (m_restart) {
+		m_restart = false;
+		loadState(m_checkpoint);
+		m_rewind.clear();
+	}
+
+	// step back one frame per update while rewind is held
+	if (m_rewinding) {
+		if (m_rewind.pop(m_frame))
+			loadState(m_frame);
+
+		// the history may have run out right after the player died,
+		// sUserInput needs a player either way
+		if (!m_player.isValid())
+			spawnPlayer();
+		return;
+	}
+
+	if (!m_player.isValid())
 		spawnPlayer();
 
-	sEnemySpawner(dt);
-	sLifespan(dt);
-	sMovement(dt);
-	sCollision();
+	m_systems.run(dt);
+
+	// the frame grows with the world, the history until it reaches its byte budget
+	AllocationScope history;
+	m_frame.clear();
+	saveState(m_frame);
+	m_rewind.push(m_frame);
+}
+
+
+void Game::saveState(Snapshot& s) const {
+	SnapshotWriter w(s);
+	m_entityManager.save(w);
+	w.write(m_player);
+	w.write(m_score);
+}
+
+
+void Game::loadState(const Snapshot& s) {
+	SnapshotReader r(s);
+	m_entityManager.load(r);
+	m_player = r.read<Entity>();
+	m_score = r.read<int>();
+}
+
+
+void Game::registerSystems() {
+	m_systems.addExclusive("enemySpawner", [this](sf::Time dt) { sEnemySpawner(dt); });
+
+	// lifespan only touches CLifespan and runs next to steering and movement
+	m_systems.addEach<Reads<>, Writes<CLifespan>>("lifespan",
+		[this] { return m_entityManager.view<CLifespan>(); }, &Game::sLifespan);
+
+	m_systems.add<Reads<CInput, CCollision>, Writes<CTransform>>("steering",
+		[this](sf::Time) { sSteering(); });
+	m_systems.addEach<Reads<>, Writes<CTransform>>("movement",
+		[this] { return m_entityManager.view<CTransform>(); }, &Game::sMovement);
 
+	m_systems.addExclusive("collision", [this](sf::Time) { sCollision(); });
 }
 
 
-void Game::sMovement(sf::Time dt) {
+void Game::sSteering() {
 
 	// keep the player and enemies in bounds
 	adjustPlayerPosition();
@@ -201,7 +303,7 @@ void Game::sMovement(sf::Time dt) {
 	// TODO set the player velocity so it is moved  according to userInput
 	// *Make sure the player always travels at the speed defined in m_playerConfig*
 	sf::Vector2f pv;
-	auto& pInput = m_player->getComponent<CInput>();
+	auto& pInput = m_player.getComponent<CInput>();
 	if (pInput.left)
 		pv.x -= 1;
 	if (pInput.right)
@@ -212,109 +314,168 @@ void Game::sMovement(sf::Time dt) {
 		pv.y += 1;
 
 	pv = m_playerConfig.S * normalize(pv);
-	m_player->getComponent<CTransform>().vel = pv;
-
-	// move all the entities
-	for (auto& e : m_entityManager.getEntities()) {
-
-		// if it has a transform move it
-		if (e->hasComponent<CTransform>() == true) {
-
-			//e->getComponent<CTransform>().tx->move(dt.asSeconds() * e->getComponent<CTransform>().vel);
-			auto& tfm = e->getComponent<CTransform>();
+	m_player.getComponent<CTransform>().vel = pv;
+}
 
 
-			// move entity
-			tfm.pos += tfm.vel * dt.asSeconds();
-			tfm.rot += tfm.rotSpeed * dt.asSeconds();
-		}
-	}
+// move all the entities that have a transform
+void Game::sMovement(sf::Time dt, CommandBuffer&, Entity, CTransform& tfm) {
+	// collisions sweep from prevPos to pos
+	tfm.prevPos = tfm.pos;
+	tfm.pos += tfm.vel * dt.asSeconds();
+	tfm.rot += tfm.rotSpeed * dt.asSeconds();
 }
 
 
-void Game::sRender() {
+void Game::sRender(RenderSnapshot& frame) {
+	frame.view = m_view;
 
 	// TODO have a different colour background to indicate the game is paused (200,200,255)
 	if (m_isPaused)
 	{
-		m_window.clear(sf::Color(200, 200, 255));
+		frame.clearColor = sf::Color(200, 200, 255);
 	}
 	else
 	{
-		m_window.clear(sf::Color(100, 100, 255));
+		frame.clearColor = sf::Color(100, 100, 255);
 	}
 
 
-	for (auto& e : m_entityManager.getEntities()) {
-		auto& tfm = e->getComponent<CTransform>();
-		auto& shape = e->getComponent<CShape>().circle;
-		shape.setPosition(tfm.pos);
-		shape.setRotation(tfm.rot);
+	// a shape per entity and a circle each with the bounding circles, the
+	// buffer only grows when the world outgrows it, once per doubling
+	const size_t shapes = m_entityManager.getEntities().size() * (m_drawBB ? 2 : 1);
+	if (frame.shapes.capacity() < shapes) {
+		AllocationScope growth;
+		frame.shapes.reserve(2 * shapes);
+	}
+
+	// CShape keeps the look, the transform says where
+	m_entityManager.view<CShape, CTransform>().each([&frame](Entity e, CShape& cShape, CTransform& tfm) {
+		RenderSnapshot::Shape shape{ tfm.pos, tfm.rot, cShape.radius, cShape.pointCount,
+			cShape.fill, cShape.outline, cShape.thickness };
 
 		// TODO fade fill color if e has a Clifespan component
 		// the alpha should be the ratio of time remaining to total time
-		if (e->hasComponent<CLifespan>())
-		{
-			auto& lifespan = e->getComponent<CLifespan>();
-			sf::Color color = shape.getFillColor();
-
+		if (e.hasComponent<CLifespan>()) {
+			auto& lifespan = e.getComponent<CLifespan>();
 			float alpha = lifespan.remaining / lifespan.total;
-			color.a = std::max(0.0f, alpha * 255);
-
-			shape.setFillColor(color);
+			shape.fill.a = static_cast<sf::Uint8>(std::max(0.0f, alpha * 255));
 		}
 
-		m_window.draw(shape);
-	}
+		frame.shapes.push_back(shape);
+		});
 
 
 	if (m_drawBB)
-		drawCR();
+		drawCR(frame);
+
+	// std::to_string and a new sf::Text would allocate every frame
+	constexpr std::string_view label{ "Score: " };
+	std::array<char, 32> buffer;
+	auto end = std::copy(label.begin(), label.end(), buffer.data());
+	end = std::to_chars(end, buffer.data() + buffer.size(), m_score).ptr;
+	frame.addText(std::string_view(buffer.data(), end - buffer.data()), m_scoreText);
+}
 
-	sf::Text score("Score: " + std::to_string(m_score), m_font);
-	score.setPosition(5, 30);
-	m_window.draw(score);
-	m_window.draw(m_statisticsText);
-	m_window.display();
+
+void Game::drawCR(RenderSnapshot& frame) {
+	m_entityManager.view<CCollision, CTransform>().each([&frame](Entity, CCollision& col, CTransform& trf) {
+		frame.shapes.push_back(RenderSnapshot::Shape{ trf.pos, 0.f, col.radius, 30,
+			sf::Color(0, 0, 0, 0), sf::Color(0, 255, 0), 1.f });
+		});
 }
 
 
-void Game::drawCR() {
-	for (auto e : m_entityManager.getEntities()) {
-		if (e->hasComponent<CCollision>()) {
-			auto cr = e->getComponent<CCollision>().radius;
-			auto trf = e->getComponent<CTransform>();
-			sf::CircleShape bCirc;
-			bCirc.setRadius(cr);
-			centerOrigin(bCirc);
-
-			bCirc.setPosition(trf.pos);
-			bCirc.setFillColor(sf::Color(0, 0, 0, 0));
-			bCirc.setOutlineColor(sf::Color(0, 255, 0));
-			bCirc.setOutlineThickness(1.f);
-			m_window.draw(bCirc);
+// main thread, the events are handled by sUserInput on the simulation thread
+void Game::pollEvents() {
+	sf::Event event;
+	while (m_window.pollEvent(event)) {
+		if (event.type == sf::Event::Closed) {
+			m_isRunning = false;
+			continue;
+		}
+
+		if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::F3) {
+			m_showStatistics = !m_showStatistics;
+			continue;
 		}
+
+		std::lock_guard<std::mutex> lock(m_inputMutex);
+		m_input.push_back(event);
 	}
 }
 
+
+// The simulation steps the world on its own thread and records a frame
+// after each round of updates. This thread polls the window and draws the
+// newest recorded frame, so frame N+1 is simulated while frame N is drawn.
 void Game::run() {
+	JobSystem::getInstance();		// created on the main thread
+	std::thread simulation([this] { simulate(); });
+
+	sf::Clock clock;
+	while (m_isRunning) {
+
+		pollEvents();
+		JobSystem::getInstance().pumpMain();
+
+		if (!m_frames.acquire()) {
+			// nothing new to show yet
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			continue;
+		}
+
+		sf::Clock renderClock;
+		const auto& frame = m_frames.front();
+		const size_t drawCalls = draw(m_window, frame);
+		m_window.draw(m_statisticsText);
+		m_window.display();
+		updateStatistics(clock.restart(), renderClock.getElapsedTime().asSeconds() * 1000.f, drawCalls + 1, frame);  // times per second world is rendered
+	}
+
+	simulation.join();
+	m_window.close();
+}
+
+
+void Game::simulate() {
 	sf::Clock clock;
 	sf::Time timeSinceLastUpdate = sf::Time::Zero;
+	int warmUp = WARM_UP_FRAMES;
 
 	while (m_isRunning) {
 
-		sUserInput();
+		timeSinceLastUpdate += clock.restart();
+		sf::Clock busyClock;
 
-		sf::Time elapsedTime = clock.restart();
-		timeSinceLastUpdate += elapsedTime;
-		while (timeSinceLastUpdate > TIME_PER_FRAME) {
-			timeSinceLastUpdate -= TIME_PER_FRAME;
+		// once warmed up the updates and sRender must not allocate,
+		// checked in ASSERT_NO_ALLOCATIONS builds
+		NoAllocationScope steady(warmUp == 0);
+		while (timeSinceLastUpdate > m_timePerUpdate) {
+			timeSinceLastUpdate -= m_timePerUpdate;
 			sUserInput();
-			sUpdate(TIME_PER_FRAME);
+			sUpdate(m_timePerUpdate);
 		}
 
-		updateStatistics(elapsedTime);  // times per second world is rendered
-		sRender();
+		auto& frame = m_frames.back();
+		frame.clear();
+		sRender(frame);
+
+		auto& stats = frame.stats;
+		stats.collisionTests = PerfCounters::take(PerfCounters::CollisionTests);
+		stats.broadphaseMs = PerfCounters::take(PerfCounters::BroadphaseMicroseconds) / 1000.f;
+		stats.narrowphaseMs = PerfCounters::take(PerfCounters::NarrowphaseMicroseconds) / 1000.f;
+		stats.entitiesPerTag.resize(TagRegistry::getInstance().size());
+		for (size_t tag{ 0 }; tag < stats.entitiesPerTag.size(); ++tag)
+			stats.entitiesPerTag[tag] = static_cast<uint32_t>(m_entityManager.getEntities(static_cast<TagId>(tag)).size());
+		m_entityManager.componentMemory(stats.componentBytes);
+		stats.simMs = busyClock.getElapsedTime().asSeconds() * 1000.f;
+		m_frames.publish();
+		if (warmUp > 0)
+			--warmUp;
+
+		// nothing to do until the next step is due
+		std::this_thread::sleep_for(std::chrono::microseconds((m_timePerUpdate - timeSinceLastUpdate).asMicroseconds()));
 	}
 }
 
@@ -337,6 +498,12 @@ Game::loadConfigFromFile(const std::string& path) {
 		if (token == "Window") {
 			config >> m_windowSize.x >> m_windowSize.y;
 		}
+		else if (token == "Simulation") {
+			float rate;
+			config >> rate;
+			if (rate > 0.f)
+				m_timePerUpdate = sf::seconds(1.f / rate);
+		}
 		else if (token == "Font") {
 			std::string path;
 			config >> path;
@@ -381,19 +548,100 @@ Game::loadConfigFromFile(const std::string& path) {
 }
 
 
-void Game::updateStatistics(sf::Time dt) {
+void Game::updateStatistics(sf::Time dt, float renderMs, size_t drawCalls, const RenderSnapshot& frame) {
+	m_frameTimes.add(dt.asSeconds() * 1000.f);
 	m_statisticsUpdateTime += dt;
 	m_statisticsNumFrames += 1;
+	m_renderMs += renderMs;
+	m_drawCalls += drawCalls;
 	if (m_statisticsUpdateTime >= sf::seconds(1.0f)) {
-		m_statisticsText.setString("FPS: " + std::to_string(m_statisticsNumFrames));
+		// average busy share of the job system workers over the last second
+		auto& jobs = JobSystem::getInstance();
+		double busy{ 0. };
+		for (const auto& worker : jobs.stats())
+			busy += worker.utilisation;
+		const int workers = static_cast<int>(jobs.workerCount());
+		jobs.resetStats();
+
+		std::ostringstream text;
+		text << std::fixed << std::setprecision(1);
+		text << "FPS: " << m_statisticsNumFrames
+			<< "\nWorkers: " << workers << " at " << static_cast<int>(100. * busy / std::max(1, workers)) << "%";
+
+		// percentiles show the hitches an average frame rate hides
+		const uint64_t allocations = MemoryTracker::allocations();
+		if (m_showStatistics) {
+			const auto& stats = frame.stats;
+			text << "\nframe p50 " << m_frameTimes.percentile(0.5f)
+				<< "  p95 " << m_frameTimes.percentile(0.95f)
+				<< "  p99 " << m_frameTimes.percentile(0.99f) << " ms"
+				<< "\nsim " << stats.simMs << " ms   render " << m_renderMs / m_statisticsNumFrames << " ms"
+				<< "\ndraw calls " << m_drawCalls / m_statisticsNumFrames
+				<< "\ncollision pairs " << stats.collisionTests
+				<< "   broadphase " << stats.broadphaseMs << " ms   narrowphase " << stats.narrowphaseMs << " ms"
+				<< "\nallocations " << (allocations - m_allocations) / m_statisticsNumFrames << " / frame";
+
+			for (size_t tag{ 0 }; tag < stats.entitiesPerTag.size(); ++tag)
+				if (stats.entitiesPerTag[tag] > 0)
+					text << "\n  " << TagRegistry::getInstance().getName(static_cast<TagId>(tag)) << " " << stats.entitiesPerTag[tag];
+
+			for (size_t c{ 0 }; c < stats.componentBytes.size(); ++c)
+				text << "\n  " << COMPONENT_NAMES[c] << " " << stats.componentBytes[c] / 1024.f << " KB";
+		}
+
+		m_statisticsText.setString(text.str());
 		m_statisticsUpdateTime -= sf::seconds(1.0f);
 		m_statisticsNumFrames = 0;
+		m_renderMs = 0.f;
+		m_drawCalls = 0;
+		m_allocations = allocations;
 	}
 
 }
 
 
 void Game::sCollision() {
+	sf::Clock clock;
+
+	// broadphase, the enemies go in grids the player and the bullets query;
+	// each is entered by the circle around everything it swept this update
+	auto bounds = [](const CTransform& tfm, float radius) {
+		return std::pair((tfm.prevPos + tfm.pos) / 2.f, radius + length(tfm.pos - tfm.prevPos) / 2.f);
+		};
+	auto fill = [&bounds, this](SpatialHash& grid, TagId tag) {
+		grid.clear();
+		for (auto& e : m_entityManager.getEntities(tag)) {
+			const auto [center, reach] = bounds(e.getComponent<CTransform>(), e.getComponent<CCollision>().radius);
+			grid.insert(e, center, reach);
+		}
+		grid.build();
+		};
+	fill(m_largeEnemies, Tag::largeEnemy);
+	fill(m_smallEnemies, Tag::smallEnemy);
+	PerfCounters::add(PerfCounters::BroadphaseMicroseconds, clock.restart().asMicroseconds());
+
+	// narrowphase, circles swept from prevPos to pos, so a fast bullet or
+	// a long update cannot step over an enemy; the earliest impact wins.
+	// Whatever a hit destroyed stays in the grids until the next update,
+	// skip the inactive ones or a bullet could score twice
+	struct Hit {
+		Entity	enemy;
+		float	time{ 2.f };	// fraction of the update, after it
+	};
+	uint64_t tests{ 0 };
+	auto earliest = [&tests](const CTransform& tfm, float radius, Hit& hit) {
+		return [&tests, from = tfm.prevPos, to = tfm.pos, radius, &hit](const SpatialHash::Item& item) {
+			if (!item.entity.isActive())
+				return;
+			++tests;
+
+			const auto& enemy = item.entity.getComponent<CTransform>();
+			const auto time = Physics::sweptCircle(from, to, radius,
+				enemy.prevPos, enemy.pos, item.entity.getComponent<CCollision>().radius);
+			if (time && *time < hit.time)
+				hit = Hit{ item.entity, *time };
+			};
+		};
 
 
 	// TODO player collides with enemy
@@ -402,22 +650,20 @@ void Game::sCollision() {
 	//      * destroy player (we will respawn destroyed player in update)
 	//      * score -500 points for being killed
 
-	for (auto& e : m_entityManager.getEntities("largeEnemy"))
+	if (m_player.isActive())
 	{
-		auto& pRadius = m_player->getComponent<CCollision>().radius;
-		auto& pPos = m_player->getComponent<CTransform>().pos;
-
-		auto& eRadius = e->getComponent<CCollision>().radius;
-		auto& ePos = e->getComponent<CTransform>().pos;
+		const CTransform& pTfm = m_player.getComponent<CTransform>();
+		const float pRadius = m_player.getComponent<CCollision>().radius;
+		const auto [center, reach] = bounds(pTfm, pRadius);
 
-		float sumOfRadius = pRadius + eRadius;
-		float distance = dist(pPos, ePos);
+		Hit hit;
+		m_largeEnemies.query(center, reach, earliest(pTfm, pRadius, hit));
 
-		if (distance < sumOfRadius)
+		if (hit.enemy.isActive())
 		{
-			e->destroy();
+			hit.enemy.destroy();
 
-			m_player->destroy();
+			m_player.destroy();
 			m_score -= 500;
 		}
 	}
@@ -439,50 +685,31 @@ void Game::sCollision() {
 	//          * destroy the enemy
 	//          * score the points
 
-	for (auto& bullet : m_entityManager.getEntities("bullet"))
+	for (auto& bullet : m_entityManager.getEntities(Tag::bullet))
 	{
-		for (auto& enemy : m_entityManager.getEntities("largeEnemy"))
-		{
-			auto& bRadius = bullet->getComponent<CCollision>().radius;
-			auto& bPos = bullet->getComponent<CTransform>().pos;
-
-			auto& eRadius = enemy->getComponent<CCollision>().radius;
-			auto& ePos = enemy->getComponent<CTransform>().pos;
-
-			float sumOfRadius = bRadius + eRadius;
-			float distance = dist(bPos, ePos);
+		// copies, spawning small enemies may move the components
+		const CTransform bTfm = bullet.getComponent<CTransform>();
+		const float bRadius = bullet.getComponent<CCollision>().radius;
+		const auto [center, reach] = bounds(bTfm, bRadius);
 
-			if (distance < sumOfRadius)
-			{
-				bullet->destroy();
-				enemy->destroy();
+		Hit hit;
+		m_largeEnemies.query(center, reach, earliest(bTfm, bRadius, hit));
+		m_smallEnemies.query(center, reach, earliest(bTfm, bRadius, hit));
 
-				m_score += enemy->getComponent<CScore>().score;
+		if (!hit.enemy.isActive())
+			continue;
 
-				spawnSmallEnemies(enemy);
-			}
-		}
-
-		for (auto& enemy : m_entityManager.getEntities("smallEnemy"))
-		{
-			auto& bRadius = bullet->getComponent<CCollision>().radius;
-			auto& bPos = bullet->getComponent<CTransform>().pos;
+		bullet.destroy();
+		hit.enemy.destroy();
 
-			auto& eRadius = enemy->getComponent<CCollision>().radius;
-			auto& ePos = enemy->getComponent<CTransform>().pos;
+		m_score += hit.enemy.getComponent<CScore>().score;
 
-			float sumOfRadius = bRadius + eRadius;
-			float distance = dist(bPos, ePos);
-
-			if (distance < sumOfRadius)
-			{
-				bullet->destroy();
-				enemy->destroy();
-
-				m_score += enemy->getComponent<CScore>().score;
-			}
-		}
+		if (hit.enemy.getTag() == Tag::largeEnemy)
+			spawnSmallEnemies(hit.enemy);
 	}
+
+	PerfCounters::add(PerfCounters::NarrowphaseMicroseconds, clock.getElapsedTime().asMicroseconds());
+	PerfCounters::add(PerfCounters::CollisionTests, tests);
 }
 
 
@@ -492,10 +719,8 @@ void Game::keepObjecsInBounds() {
 
 	// TODO Keep all enemy objects in bounds
 	// if an object collides with a wall it should bounce off the wall
-	for (auto& e : m_entityManager.getEntities())
-	{
-		auto& radius = e->getComponent<CCollision>().radius;
-		auto& transform = e->getComponent<CTransform>();
+	m_entityManager.view<CTransform, CCollision>().each([&vb](Entity, CTransform& transform, CCollision& col) {
+		auto& radius = col.radius;
 
 		if (transform.pos.x - radius <= vb.left ||
 			transform.pos.x + radius >= vb.left + vb.width)
@@ -508,7 +733,7 @@ void Game::keepObjecsInBounds() {
 		{
 			transform.vel.y *= -1;
 		}
-	}
+		});
 }
 
 
@@ -516,8 +741,8 @@ void Game::adjustPlayerPosition() {
 	auto vb = getViewBounds();
 
 	// TODO keep player in bounds
-	auto& radius = m_player->getComponent<CCollision>().radius;
-	auto& pos = m_player->getComponent<CTransform>().pos;
+	auto& radius = m_player.getComponent<CCollision>().radius;
+	auto& pos = m_player.getComponent<CTransform>().pos;
 
 	pos.x = std::max(pos.x, vb.left + radius);
 	pos.x = std::min(pos.x, vb.left + vb.width - radius);
@@ -536,9 +761,9 @@ void Game::spawnPlayer() {
 	// assign new player entity to m_player
 	// add all needed components
 	// configure player according to m_playerConfig
-	m_player = m_entityManager.addEntity("player");
+	m_player = m_entityManager.addEntity(Tag::player);
 
-	m_player->addComponent<CShape>(
+	m_player.addComponent<CShape>(
 		m_playerConfig.SR,                                                  // Shape radius
 		m_playerConfig.V,                                                   // Vertices (points)
 		sf::Color(m_playerConfig.FR, m_playerConfig.FG, m_playerConfig.FB), // Fill Color
@@ -546,11 +771,11 @@ void Game::spawnPlayer() {
 		m_playerConfig.OT                                                   // Outline Thickness
 	);
 
-	m_player->addComponent<CInput>();
+	m_player.addComponent<CInput>();
 
-	m_player->addComponent<CCollision>(m_playerConfig.CR);
+	m_player.addComponent<CCollision>(m_playerConfig.CR);
 
-	m_player->addComponent<CTransform>(
+	m_player.addComponent<CTransform>(
 		spawnPoint,                     // position
 		sf::Vector2f(0.0f, 0.0f),       // velocity
 		m_playerConfig.SR               // angular velocity
@@ -558,22 +783,16 @@ void Game::spawnPlayer() {
 }
 
 
-void Game::sLifespan(sf::Time dt) {
+void Game::sLifespan(sf::Time dt, CommandBuffer& commands, Entity e, CLifespan& lifeSpawn) {
 
 	// TODO for all entities that have a CLifespan compnent
 	// reduce the remaining life by dt time.
 	// if the lifespan has run out destroy the entity
-	for (auto& e : m_entityManager.getEntities())
-	{
-		if (e->hasComponent<CLifespan>())
-		{
-			auto& lifeSpawn = e->getComponent<CLifespan>();
-			lifeSpawn.remaining -= dt;
+	// the destroys are recorded and applied by the next update
+	lifeSpawn.remaining -= dt;
 
-			if (lifeSpawn.remaining <= sf::Time::Zero)
-				e->destroy();
-		}
-	}
+	if (lifeSpawn.remaining <= sf::Time::Zero)
+		commands.destroy(e);
 }
 
 
@@ -614,7 +833,7 @@ void Game::spawnEnemy() {
 	//  the CScore component will be the number of points the player gets for destroying this
 	//  enenmy. It should be set to the number of Verticies the enemy has
 	// tag is largeEnemy
-	auto enemy = m_entityManager.addEntity("largeEnemy");
+	auto enemy = m_entityManager.addEntity(Tag::largeEnemy);
 
 	int points = d_points(rng);
 
@@ -622,7 +841,7 @@ void Game::spawnEnemy() {
 	int g = d_color(rng);
 	int b = d_color(rng);
 
-	enemy->addComponent<CShape>(
+	enemy.addComponent<CShape>(
 		m_enemyConfig.SR,
 		d_points(rng),
 		sf::Color(r, g, b),
@@ -630,13 +849,13 @@ void Game::spawnEnemy() {
 		m_enemyConfig.OT
 	);
 
-	enemy->addComponent<CCollision>(m_enemyConfig.CR);
-	enemy->addComponent<CScore>(points);
-	enemy->addComponent<CTransform>(pos, vel);
+	enemy.addComponent<CCollision>(m_enemyConfig.CR);
+	enemy.addComponent<CScore>(points);
+	enemy.addComponent<CTransform>(pos, vel);
 }
 
 
-void Game::spawnSmallEnemies(sPtrEntt e) {
+void Game::spawnSmallEnemies(Entity e) {
 	// TODO
 	// Enemy entity e just collided with a bullet.
 	// spawn small enemies according to game rules.
@@ -652,31 +871,28 @@ void Game::spawnSmallEnemies(sPtrEntt e) {
 	//           vertices it has.
 	//   tag is smallEnemy
 
-	auto& circle = e->getComponent<CShape>().circle;
-	float angle = 360.0f / circle.getPointCount();
-
-	for (int i = 0; i < circle.getPointCount(); i++)
-	{
-		auto enemy = m_entityManager.addEntity("smallEnemy");
-
-		enemy->addComponent<CShape>(
-			circle.getRadius() / 2,
-			circle.getPointCount(),
-			circle.getFillColor(),
-			circle.getOutlineColor(),
-			circle.getOutlineThickness()
-		);
-
-		enemy->addComponent<CCollision>(e->getComponent<CCollision>().radius / 2);
-		enemy->addComponent<CScore>(e->getComponent<CScore>().score * 10);
-
-		auto& tfm = e->getComponent<CTransform>();
-
-		sf::Vector2f dir = uVecBearing(i * angle);
-
-		enemy->addComponent<CTransform>(tfm.pos, m_enemyConfig.SMAX * normalize(dir));
-		enemy->addComponent<CLifespan>(m_enemyConfig.L);
-	}
+	// one fragment is built from e, the burst is stamped out in one go
+	const auto& shape = e.getComponent<CShape>();
+	Prefab fragment(Tag::smallEnemy);
+	fragment.set<CShape>(
+			shape.radius / 2,
+			shape.pointCount,
+			shape.fill,
+			shape.outline,
+			shape.thickness)
+		.set<CCollision>(e.getComponent<CCollision>().radius / 2)
+		.set<CScore>(e.getComponent<CScore>().score * 10)
+		.set<CTransform>(sf::Vector2f(), sf::Vector2f())
+		.set<CLifespan>(m_enemyConfig.L);
+
+	const auto pos = e.getComponent<CTransform>().pos;
+	float angle = 360.0f / shape.pointCount;
+
+	m_burst.resize(shape.pointCount);
+	for (size_t i = 0; i < m_burst.size(); i++)
+		m_burst[i] = PrefabInstance{ pos, m_enemyConfig.SMAX * normalize(uVecBearing(i * angle)) };
+
+	m_entityManager.instantiate(fragment, m_burst);
 }
 
 
@@ -686,26 +902,12 @@ void Game::spawnBullet(sf::Vector2f mPos) {
 	// the bullets velocity is in the direction of the mouse click location
 	// the bullets config is according to m_bulletConfig
 	// tag is "bullet"
-	auto bullet = m_entityManager.addEntity("bullet");
-
-	bullet->addComponent<CShape>(
-		m_bulletConfig.SR,
-		m_bulletConfig.V,
-		sf::Color(m_bulletConfig.FR, m_bulletConfig.FG, m_bulletConfig.FB),
-		sf::Color(m_bulletConfig.OR, m_bulletConfig.OG, m_bulletConfig.OB),
-		m_bulletConfig.OT
-	);
-
-	bullet->addComponent<CCollision>(m_bulletConfig.CR);
-
-	auto pPos = m_player->getComponent<CTransform>().pos;
+	auto pPos = m_player.getComponent<CTransform>().pos;
 	mPos -= pPos;
 
-	bullet->addComponent<CTransform>(
-		pPos,
-		m_bulletConfig.S * normalize(mPos));
-
-	bullet->addComponent<CLifespan>(m_bulletConfig.L);
+	m_entityManager.instantiate(
+		m_entityManager.getPrefab(m_bulletPrefab),
+		PrefabInstance{ pPos, m_bulletConfig.S * normalize(mPos) });
 }
 
 
@@ -716,7 +918,7 @@ void Game::spawnSpecialWeapon() {
 
 // convenience function to return the view bounds as a FloatRect
 sf::FloatRect Game::getViewBounds() {
-	auto view = m_window.getView();
+	auto view = m_view;
 	return sf::FloatRect(
 		(view.getCenter().x - view.getSize().x / 2.f), (view.getCenter().y - view.getSize().y / 2.f),
 		view.getSize().x, view.getSize().y);
@@ -6,9 +6,17 @@
 #include <SFML/Graphics.hpp>
 #include <vector>
 #include <memory>
+#include <atomic>
+#include <mutex>
 
 #include "Entity.h"
 #include "EntityManager.h"
+#include "RewindBuffer.h"
+#include "SystemScheduler.h"
+#include "RenderSnapshot.h"
+#include "TripleBuffer.h"
+#include "PerfStats.h"
+#include "SpatialHash.h"
 
 using uint = unsigned int;
 
@@ -24,55 +32,88 @@ struct BulletConfig { int  FR, FG, FB, OR, OG, OB, OT, V, L; float SR, CR, S; };
 
 class Game {
 private:
-    const static sf::Time TIME_PER_FRAME;
+    friend struct GameBenchmark;    // benchmarks/geowar_benchmarks.cpp drives the systems directly
 
     sf::Vector2u                m_windowSize{ 1280,768 };
+    sf::Time                    m_timePerUpdate{ sf::seconds(1.f / 60.f) };
     sf::RenderWindow            m_window;
+    sf::View                    m_view;                 // the window belongs to the main thread
     EntityManager               m_entityManager;
     sf::Font                    m_font;
-    sPtrEntt                    m_player{ nullptr };
+    sf::Text                    m_scoreText;            // font and place of the score, the number is recorded per frame
+    Entity                      m_player;
     int                         m_score{ 0 };
 
     PlayerConfig                m_playerConfig;
     EnemyConfig                 m_enemyConfig;
     BulletConfig                m_bulletConfig;
+    PrefabId                    m_bulletPrefab{ 0 };
 
-    bool                        m_isRunning{ true };
+    std::atomic<bool>           m_isRunning{ true };
     bool                        m_isPaused{ false };
     bool                        m_drawBB{ false };
 
-    // stats
+    RewindBuffer                m_rewind{ 32 << 20 };
+    Snapshot                    m_frame;                // reused every update
+    Snapshot                    m_checkpoint;           // first frame of the game
+    bool                        m_rewinding{ false };
+    bool                        m_restart{ false };     // restore m_checkpoint on the next update
+
+    SystemScheduler             m_systems{ m_entityManager };
+    SpatialHash                 m_largeEnemies;         // collision broadphase, rebuilt every tick
+    SpatialHash                 m_smallEnemies;
+    std::vector<PrefabInstance> m_burst;                // reused by spawnSmallEnemies
+
+    // the main thread owns the window, the simulation thread owns the world
+    std::mutex                  m_inputMutex;
+    std::vector<sf::Event>      m_input;                // events for the simulation thread
+    std::vector<sf::Event>      m_events;               // the ones being handled, simulation thread
+    TripleBuffer<RenderSnapshot> m_frames;              // newest recorded frame for the main thread
+
+    // stats, F3 shows the details; main thread
+    bool                        m_showStatistics{ false };
     sf::Text                    m_statisticsText;
     sf::Time                    m_statisticsUpdateTime{ sf::Time::Zero };
     unsigned int                m_statisticsNumFrames{ 0 };
+    FrameTimes                  m_frameTimes;
+    float                       m_renderMs{ 0.f };      // summed since the text was last updated
+    size_t                      m_drawCalls{ 0 };
+    uint64_t                    m_allocations{ 0 };     // MemoryTracker count when the text was last updated
 
 
     // Systems
-    void                        sMovement(sf::Time dt);
+    static void                 sMovement(sf::Time dt, CommandBuffer& commands, Entity e, CTransform& tfm);
+    void                        sSteering();
     void                        sUserInput();
-    void                        sLifespan(sf::Time dt);
-    void                        sRender();
+    static void                 sLifespan(sf::Time dt, CommandBuffer& commands, Entity e, CLifespan& lifespan);
+    void                        sRender(RenderSnapshot& frame);
     void                        sEnemySpawner(sf::Time dt);
     void                        sCollision();
     void                        sUpdate(sf::Time dt);
+    void                        simulate();
+    void                        registerSystems();
 
 
     // helpers
     void                        adjustPlayerPosition();
     void                        spawnPlayer();
     void                        spawnEnemy();
-    void                        spawnSmallEnemies(sPtrEntt e);
+    void                        spawnSmallEnemies(Entity e);
     void                        spawnBullet(sf::Vector2f dir);
     void                        spawnSpecialWeapon();
-    void                        updateStatistics(sf::Time dt);
+    void                        updateStatistics(sf::Time dt, float renderMs, size_t drawCalls, const RenderSnapshot& frame);
     void                        loadConfigFromFile(const std::string& path);
     sf::FloatRect               getViewBounds();
     void                        keepObjecsInBounds();
-    void                        drawCR();
+    void                        pollEvents();
+    void                        drawCR(RenderSnapshot& frame);
+    void                        saveState(Snapshot& s) const;
+    void                        loadState(const Snapshot& s);
 
 public:
 
-    Game(const std::string& path);
+    // headless opens no window, for the benchmarks; run() needs one
+    Game(const std::string& path, bool headless = false);
     void run();
 
 
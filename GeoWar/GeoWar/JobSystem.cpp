@@ -0,0 +1,253 @@
+#include "JobSystem.h"
+
+
+JobSystem::JobSystem()
+    : m_mainThread(std::this_thread::get_id())
+    , m_statsSince(std::chrono::steady_clock::now()) {
+    // the main thread keeps a core to itself
+    const size_t hardware = std::max(2u, std::thread::hardware_concurrency());
+    const size_t count = std::min(MAX_WORKERS, hardware - 1);
+
+    for (size_t i{ 0 }; i < count; ++i)
+        m_workers.push_back(std::make_unique<Worker>());
+    for (size_t i{ 0 }; i < count; ++i)
+        m_threads.emplace_back([this, i] { workerLoop(static_cast<int>(i)); });
+}
+
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+        m_quit = true;
+    }
+    m_wake.notify_all();
+    for (auto& thread : m_threads)
+        thread.join();
+}
+
+
+JobSystem& JobSystem::getInstance() {
+    static JobSystem instance; // Meyers Singleton implementation
+    return instance;
+}
+
+
+JobSystem::Handle JobSystem::submit(std::function<void()> job, std::initializer_list<Handle> after) {
+    return submit(std::move(job), after, false);
+}
+
+
+JobSystem::Handle JobSystem::submitMain(std::function<void()> job, std::initializer_list<Handle> after) {
+    return submit(std::move(job), after, true);
+}
+
+
+JobSystem::Handle JobSystem::submit(std::function<void()> job, std::initializer_list<Handle> after, bool mainThread) {
+    auto task = std::make_shared<Task>();
+    task->job = std::move(job);
+    task->mainThread = mainThread;
+    task->pending = 1 + after.size();
+
+    for (const auto& dependency : after) {
+        if (!dependency.m_task) {
+            task->pending.fetch_sub(1);
+            continue;
+        }
+        std::lock_guard<std::mutex> lock(dependency.m_task->mutex);
+        if (dependency.m_task->done)
+            task->pending.fetch_sub(1);
+        else
+            dependency.m_task->continuations.push_back(task);
+    }
+
+    // drop the submission count, the last dependency may have finished already
+    if (task->pending.fetch_sub(1) == 1)
+        schedule(task);
+    return Handle(task);
+}
+
+
+void JobSystem::schedule(TaskPtr task) {
+    if (task->mainThread) {
+        std::lock_guard<std::mutex> lock(m_mainMutex);
+        m_main.push_back(std::move(task));
+        return;
+    }
+
+    if (t_workerId != 0) {
+        auto& worker = *m_workers[t_workerId - 1];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        worker.tasks.push_back(std::move(task));
+    }
+    else {
+        std::lock_guard<std::mutex> lock(m_sharedMutex);
+        m_shared.push_back(std::move(task));
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+        ++m_queued;
+    }
+    m_wake.notify_one();
+}
+
+
+// worker is the index in m_workers, -1 for threads outside the pool
+void JobSystem::execute(const TaskPtr& task, int worker) {
+    const auto start = std::chrono::steady_clock::now();
+    task->job();
+    task->job = nullptr;
+
+    if (worker >= 0) {
+        auto& w = *m_workers[worker];
+        w.busyNs += std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count();
+        ++w.jobs;
+    }
+
+    std::vector<TaskPtr> continuations;
+    {
+        std::lock_guard<std::mutex> lock(task->mutex);
+        task->done = true;
+        continuations.swap(task->continuations);
+    }
+    for (auto& next : continuations)
+        if (next->pending.fetch_sub(1) == 1)
+            schedule(std::move(next));
+}
+
+
+// own deque newest first, then the shared queue, then the oldest job of another worker
+JobSystem::TaskPtr JobSystem::takeTask(int worker, bool& stolen) {
+    stolen = false;
+    TaskPtr task;
+
+    if (worker >= 0) {
+        auto& own = *m_workers[worker];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+        }
+    }
+
+    if (!task) {
+        std::lock_guard<std::mutex> lock(m_sharedMutex);
+        if (!m_shared.empty()) {
+            task = std::move(m_shared.front());
+            m_shared.pop_front();
+        }
+    }
+
+    const size_t n = m_workers.size();
+    const size_t start = worker >= 0 ? static_cast<size_t>(worker) : 0;
+    for (size_t k{ 0 }; !task && k < n; ++k) {
+        const size_t idx = (start + k) % n;
+        if (static_cast<int>(idx) == worker)
+            continue;
+        auto& victim = *m_workers[idx];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            stolen = true;
+        }
+    }
+
+    if (task)
+        --m_queued;
+    return task;
+}
+
+
+bool JobSystem::runOne() {
+    if (isMainThread()) {
+        TaskPtr task;
+        {
+            std::lock_guard<std::mutex> lock(m_mainMutex);
+            if (!m_main.empty()) {
+                task = std::move(m_main.front());
+                m_main.pop_front();
+            }
+        }
+        if (task) {
+            execute(task, -1);
+            return true;
+        }
+    }
+
+    const int worker = static_cast<int>(t_workerId) - 1;
+    bool stolen;
+    auto task = takeTask(worker, stolen);
+    if (!task)
+        return false;
+    if (stolen && worker >= 0)
+        ++m_workers[worker]->steals;
+    execute(task, worker);
+    return true;
+}
+
+
+void JobSystem::wait(const Handle& h) {
+    while (!h.done()) {
+        if (!runOne())
+            std::this_thread::yield();
+    }
+}
+
+
+void JobSystem::pumpMain() {
+    std::deque<TaskPtr> tasks;
+    {
+        std::lock_guard<std::mutex> lock(m_mainMutex);
+        tasks.swap(m_main);
+    }
+    for (auto& task : tasks)
+        execute(task, -1);
+}
+
+
+void JobSystem::workerLoop(int worker) {
+    t_workerId = static_cast<uint32_t>(worker + 1);
+
+    for (;;) {
+        bool stolen;
+        if (auto task = takeTask(worker, stolen)) {
+            if (stolen)
+                ++m_workers[worker]->steals;
+            execute(task, worker);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(m_sleepMutex);
+        m_wake.wait(lock, [this] { return m_quit || m_queued > 0; });
+        if (m_quit)
+            return;
+    }
+}
+
+
+std::vector<JobSystem::WorkerStats> JobSystem::stats() const {
+    const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_statsSince).count();
+
+    std::vector<WorkerStats> result;
+    for (const auto& worker : m_workers) {
+        WorkerStats s;
+        s.jobs = worker->jobs;
+        s.steals = worker->steals;
+        s.busySeconds = worker->busyNs / 1e9;
+        s.utilisation = elapsed > 0. ? std::min(1., s.busySeconds / elapsed) : 0.;
+        result.push_back(s);
+    }
+    return result;
+}
+
+
+void JobSystem::resetStats() {
+    for (auto& worker : m_workers) {
+        worker->jobs = 0;
+        worker->steals = 0;
+        worker->busyNs = 0;
+    }
+    m_statsSince = std::chrono::steady_clock::now();
+}
\ No newline at end of file
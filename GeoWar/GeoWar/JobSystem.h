@@ -0,0 +1,164 @@
+#ifndef GEOWARS_JOBSYSTEM_H
+#define GEOWARS_JOBSYSTEM_H
+
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <initializer_list>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <algorithm>
+
+
+// Work-stealing thread pool shared by the whole engine.
+// Every worker owns a deque: it pushes and pops its own jobs at the back
+// and, when it runs dry, steals the oldest job from the front of another
+// worker's deque. Jobs submitted from outside the pool go to a shared
+// queue. A job may wait for other jobs, it is queued once the last of
+// them has finished.
+//
+// SFML objects that talk to OpenGL belong to the main thread, jobs for
+// them are submitted with submitMain() and run when the main thread calls
+// pumpMain() or waits on a job.
+class JobSystem {
+public:
+    static constexpr size_t MAX_WORKERS{ 63 };
+
+private:
+    struct Task {
+        std::function<void()>               job;
+        std::atomic<size_t>                 pending{ 1 };   // unfinished dependencies + submission
+        std::atomic<bool>                   done{ false };
+        bool                                mainThread{ false };
+        std::mutex                          mutex;          // guards continuations
+        std::vector<std::shared_ptr<Task>>  continuations;
+    };
+    using TaskPtr = std::shared_ptr<Task>;
+
+public:
+    class Handle {
+    private:
+        friend class JobSystem;
+        TaskPtr             m_task;
+        explicit Handle(TaskPtr task) : m_task(std::move(task)) {}
+
+    public:
+        Handle() = default;
+        bool                done() const { return !m_task || m_task->done; }
+    };
+
+    struct WorkerStats {
+        uint64_t            jobs{ 0 };
+        uint64_t            steals{ 0 };
+        double              busySeconds{ 0. };
+        double              utilisation{ 0. };      // busy share of the time since resetStats()
+    };
+
+private:
+    // one per worker, padded so the counters of neighbours do not share a cache line
+    struct alignas(64) Worker {
+        std::mutex                  mutex;
+        std::deque<TaskPtr>         tasks;
+        std::atomic<uint64_t>       jobs{ 0 };
+        std::atomic<uint64_t>       steals{ 0 };
+        std::atomic<uint64_t>       busyNs{ 0 };
+    };
+
+    // singleton class
+    JobSystem();
+    ~JobSystem();
+
+    std::vector<std::unique_ptr<Worker>>    m_workers;
+    std::vector<std::thread>                m_threads;
+    std::thread::id                         m_mainThread;
+
+    std::mutex                              m_sharedMutex;
+    std::deque<TaskPtr>                     m_shared;       // submitted from outside the pool
+    std::mutex                              m_mainMutex;
+    std::deque<TaskPtr>                     m_main;         // main thread only
+
+    std::mutex                              m_sleepMutex;
+    std::condition_variable                 m_wake;
+    std::atomic<size_t>                     m_queued{ 0 };  // jobs in worker and shared queues
+    bool                                    m_quit{ false };
+
+    std::chrono::steady_clock::time_point   m_statsSince;
+
+    static inline thread_local uint32_t     t_workerId{ 0 };
+
+    Handle                  submit(std::function<void()> job, std::initializer_list<Handle> after, bool mainThread);
+    void                    schedule(TaskPtr task);
+    void                    execute(const TaskPtr& task, int worker);
+    TaskPtr                 takeTask(int worker, bool& stolen);
+    bool                    runOne();
+    void                    workerLoop(int worker);
+
+public:
+    static JobSystem&       getInstance();
+
+    // no copy or move
+    JobSystem(const JobSystem&) = delete;
+    JobSystem(JobSystem&&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+    JobSystem& operator=(JobSystem&&) = delete;
+
+    // job runs on a worker once every job in `after` has finished
+    Handle                  submit(std::function<void()> job, std::initializer_list<Handle> after = {});
+
+    // job runs on the main thread once every job in `after` has finished
+    Handle                  submitMain(std::function<void()> job, std::initializer_list<Handle> after = {});
+
+    // runs other jobs until h has finished, main-thread jobs as well when
+    // called from the main thread
+    void                    wait(const Handle& h);
+
+    // runs the queued main-thread jobs, the main loop calls this once a frame
+    void                    pumpMain();
+
+    // f(first, last) over [begin, end) in pieces of at most grain,
+    // returns when all pieces are done. The caller works on them too.
+    template<typename F>
+    void                    parallelFor(size_t begin, size_t end, size_t grain, F&& f);
+
+    size_t                  workerCount() const { return m_workers.size(); }
+    bool                    isMainThread() const { return std::this_thread::get_id() == m_mainThread; }
+
+    // 0 on the main thread or any thread outside the pool, 1..workerCount() on the workers
+    static uint32_t         workerId() { return t_workerId; }
+
+    std::vector<WorkerStats> stats() const;
+    void                    resetStats();
+};
+
+
+template<typename F>
+void JobSystem::parallelFor(size_t begin, size_t end, size_t grain, F&& f) {
+    if (begin >= end)
+        return;
+    grain = std::max<size_t>(1, grain);
+
+    // no point in a job for the only piece
+    if (end - begin <= grain || m_workers.empty()) {
+        for (size_t first{ begin }; first < end; first += grain)
+            f(first, std::min(end, first + grain));
+        return;
+    }
+
+    std::vector<Handle> pieces;
+    pieces.reserve((end - begin) / grain + 1);
+    for (size_t first{ begin }; first < end; first += grain) {
+        const size_t last = std::min(end, first + grain);
+        pieces.push_back(submit([&f, first, last] { f(first, last); }));
+    }
+    for (const auto& piece : pieces)
+        wait(piece);
+}
+
+
+#endif //GEOWARS_JOBSYSTEM_H
\ No newline at end of file
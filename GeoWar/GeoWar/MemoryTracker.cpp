@@ -0,0 +1,76 @@
+#include "MemoryTracker.h"
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+
+namespace {
+    std::atomic<uint64_t> allocationCount{ 0 };
+
+    // plain data, usable before and after the thread's other thread_locals
+    thread_local bool t_forbidden{ false };
+
+#ifdef ASSERT_NO_ALLOCATIONS
+    // no allocation in here, we are inside operator new
+    [[noreturn]] void reportAllocation(std::size_t size) {
+        t_forbidden = false;
+        std::fprintf(stderr, "Allocation of %zu bytes where none are allowed\n", size);
+        std::abort();
+    }
+#endif
+
+    void* allocate(std::size_t size) {
+#ifdef ASSERT_NO_ALLOCATIONS
+        if (t_forbidden)
+            reportAllocation(size);
+#endif
+        allocationCount.fetch_add(1, std::memory_order_relaxed);
+        if (void* p = std::malloc(size ? size : 1))
+            return p;
+        throw std::bad_alloc();
+    }
+}
+
+
+uint64_t MemoryTracker::allocations() {
+    return allocationCount.load(std::memory_order_relaxed);
+}
+
+
+bool MemoryTracker::forbid(bool forbidden) {
+    const bool previous = t_forbidden;
+    t_forbidden = forbidden;
+    return previous;
+}
+
+
+bool MemoryTracker::forbidden() {
+    return t_forbidden;
+}
+
+
+// the array, nothrow and sized forms of the standard library forward here
+void* operator new(std::size_t size) {
+    return allocate(size);
+}
+
+void* operator new[](std::size_t size) {
+    return allocate(size);
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept {
+    std::free(p);
+}
\ No newline at end of file
@@ -0,0 +1,26 @@
+#include "Physics.h"
+#include <cmath>
+
+
+// solves |start + motion t| = reach for the first t, b stands still
+std::optional<float> Physics::sweptCircle(sf::Vector2f aFrom, sf::Vector2f aTo, float aRadius,
+    sf::Vector2f bFrom, sf::Vector2f bTo, float bRadius) {
+    const sf::Vector2f start = aFrom - bFrom;
+    const sf::Vector2f motion = (aTo - aFrom) - (bTo - bFrom);
+    const float reach = aRadius + bRadius;
+
+    const float c = start.x * start.x + start.y * start.y - reach * reach;
+    if (c < 0.f)
+        return 0.f;
+
+    const float a = motion.x * motion.x + motion.y * motion.y;
+    const float b = start.x * motion.x + start.y * motion.y;
+    const float discriminant = b * b - a * c;
+    if (a == 0.f || b >= 0.f || discriminant <= 0.f)
+        return std::nullopt;     // no motion, moving apart or passing wide
+
+    const float t = (-b - std::sqrt(discriminant)) / a;
+    if (t > 1.f)
+        return std::nullopt;
+    return t;
+}
\ No newline at end of file
@@ -0,0 +1,19 @@
+#ifndef GEOWARS_PHYSICS_H
+#define GEOWARS_PHYSICS_H
+
+
+#include <SFML/System/Vector2.hpp>
+#include <optional>
+
+
+namespace Physics {
+    // Two circles moving in straight lines from ...From to ...To over one
+    // update: the fraction of the update, in [0, 1], at which they first
+    // overlap, 0 if they already do, nothing if they never do. A bullet
+    // cannot pass through an enemy between updates however fast it is.
+    std::optional<float> sweptCircle(sf::Vector2f aFrom, sf::Vector2f aTo, float aRadius,
+        sf::Vector2f bFrom, sf::Vector2f bTo, float bRadius);
+}
+
+
+#endif //GEOWARS_PHYSICS_H
\ No newline at end of file
@@ -0,0 +1,60 @@
+#ifndef GEOWARS_PREFAB_H
+#define GEOWARS_PREFAB_H
+
+
+#include <tuple>
+#include <optional>
+#include <cstdint>
+#include <utility>
+
+#include "Components.h"
+#include "Tags.h"
+
+
+using PrefabId = uint32_t;
+
+
+// one optional slot per type in ComponentTuple
+template<typename Tuple> struct OptionalTuple;
+template<typename... Ts> struct OptionalTuple<std::tuple<Ts...>> {
+    using type = std::tuple<std::optional<Ts>...>;
+};
+using PrefabComponents = OptionalTuple<ComponentTuple>::type;
+
+
+// per-instance overrides, written over the prefab's CTransform
+struct PrefabInstance {
+    sf::Vector2f        pos{ 0.f, 0.f };
+    sf::Vector2f        vel{ 0.f, 0.f };
+};
+
+
+// A block of components built once and copied onto every entity
+// EntityManager::instantiate() spawns from it.
+class Prefab {
+private:
+    TagId               m_tag{ Tag::Default };
+    PrefabComponents    m_components;
+
+public:
+    Prefab() = default;
+    explicit Prefab(TagId tag) : m_tag(tag) {}
+
+    TagId tag() const { return m_tag; }
+
+
+    template<typename T, typename... TArgs>
+    Prefab& set(TArgs &&... mArgs) {
+        std::get<std::optional<T>>(m_components).emplace(std::forward<TArgs>(mArgs)...);
+        return *this;
+    }
+
+
+    template<typename T>
+    const std::optional<T>& get() const {
+        return std::get<std::optional<T>>(m_components);
+    }
+};
+
+
+#endif //GEOWARS_PREFAB_H
\ No newline at end of file
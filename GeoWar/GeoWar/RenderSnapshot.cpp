@@ -0,0 +1,65 @@
+#include "RenderSnapshot.h"
+
+
+void RenderSnapshot::clear() {
+    clearColor.reset();
+    shapes.clear();
+    texts.clear();
+    chars.clear();
+
+    stats.simMs = 0.f;
+    stats.collisionTests = 0;
+    stats.broadphaseMs = 0.f;
+    stats.narrowphaseMs = 0.f;
+    stats.entitiesPerTag.clear();
+    stats.componentBytes.clear();
+}
+
+
+void RenderSnapshot::addText(std::string_view string, const sf::Text& style) {
+    texts.push_back(Text{
+        static_cast<uint32_t>(chars.size()),
+        static_cast<uint32_t>(string.size()),
+        style.getFont(),
+        style.getCharacterSize(),
+        style.getPosition(),
+        style.getFillColor() });
+    chars.append(string);
+}
+
+
+size_t draw(sf::RenderTarget& target, const RenderSnapshot& frame) {
+    size_t calls{ 0 };
+    target.setView(frame.view);
+    if (frame.clearColor)
+        target.clear(*frame.clearColor);
+
+    sf::CircleShape circle;
+    for (const auto& s : frame.shapes) {
+        circle.setRadius(s.radius);
+        circle.setPointCount(s.pointCount);
+        circle.setOrigin(s.radius, s.radius);
+        circle.setPosition(s.position);
+        circle.setRotation(s.rotation);
+        circle.setFillColor(s.fill);
+        circle.setOutlineColor(s.outline);
+        circle.setOutlineThickness(s.thickness);
+        target.draw(circle);
+        ++calls;
+    }
+
+    sf::Text text;
+    for (const auto& t : frame.texts) {
+        if (!t.font)
+            continue;
+        text.setFont(*t.font);
+        const char* first = frame.chars.data() + t.first;
+        text.setString(sf::String::fromUtf8(first, first + t.length));
+        text.setCharacterSize(t.characterSize);
+        text.setPosition(t.position);
+        text.setFillColor(t.color);
+        target.draw(text);
+        ++calls;
+    }
+    return calls;
+}
\ No newline at end of file
@@ -0,0 +1,67 @@
+#ifndef GEOWARS_RENDERSNAPSHOT_H
+#define GEOWARS_RENDERSNAPSHOT_H
+
+
+#include <vector>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <cstdint>
+#include <SFML/Graphics.hpp>
+
+
+// Everything the main thread needs to draw one frame. The simulation
+// thread records it and hands it over through a TripleBuffer, after that
+// nobody writes to it, so drawing never touches the entities.
+struct RenderSnapshot {
+    // regular polygon around its centre, CShape and the collision circles
+    struct Shape {
+        sf::Vector2f        position;
+        float               rotation{ 0.f };
+        float               radius{ 0.f };
+        size_t              pointCount{ 30 };
+        sf::Color           fill;
+        sf::Color           outline;
+        float               thickness{ 0.f };
+    };
+
+    // the string is [first, first + length) of chars
+    struct Text {
+        uint32_t            first{ 0 };
+        uint32_t            length{ 0 };
+        const sf::Font*     font{ nullptr };
+        unsigned int        characterSize{ 30 };
+        sf::Vector2f        position;
+        sf::Color           color{ sf::Color::White };
+    };
+
+    // what the simulation did for this frame, for the statistics
+    struct Stats {
+        float                   simMs{ 0.f };           // updates and recording
+        uint64_t                collisionTests{ 0 };
+        float                   broadphaseMs{ 0.f };
+        float                   narrowphaseMs{ 0.f };
+        std::vector<uint32_t>   entitiesPerTag;         // indexed by TagId
+        std::vector<size_t>     componentBytes;         // pool memory, indexed like ComponentTuple
+    };
+
+    sf::View                    view;
+    std::optional<sf::Color>    clearColor;
+    std::vector<Shape>          shapes;     // back to front
+    std::vector<Text>           texts;      // over the shapes
+    std::string                 chars;      // the text of every Text, back to back
+    Stats                       stats;
+
+    // keeps the capacity, a recycled buffer stops allocating after a few frames
+    void                        clear();
+
+    // the string, with font, size, position and colour of style
+    void                        addText(std::string_view string, const sf::Text& style);
+};
+
+
+// main thread only, returns the draw calls
+size_t draw(sf::RenderTarget& target, const RenderSnapshot& frame);
+
+
+#endif //GEOWARS_RENDERSNAPSHOT_H
\ No newline at end of file
@@ -0,0 +1,166 @@
+#include "RewindBuffer.h"
+#include <algorithm>
+
+
+namespace {
+    // zero runs shorter than this stay inside the literal
+    constexpr size_t MIN_ZERO_RUN{ 8 };
+    constexpr size_t MAX_SPARE_BUFFERS{ 64 };
+
+
+    std::byte baseAt(const Snapshot& base, size_t i) {
+        return i < base.size() ? base[i] : std::byte{ 0 };
+    }
+
+
+    void writeRun(std::vector<std::byte>& out, uint32_t zeros, uint32_t literal) {
+        auto p = reinterpret_cast<const std::byte*>(&zeros);
+        out.insert(out.end(), p, p + sizeof(zeros));
+        p = reinterpret_cast<const std::byte*>(&literal);
+        out.insert(out.end(), p, p + sizeof(literal));
+    }
+
+
+    // pairs of (zero count, literal count) followed by the literal XOR bytes
+    void encodeDelta(const Snapshot& base, const Snapshot& s, std::vector<std::byte>& out) {
+        out.clear();
+        size_t i{ 0 };
+        while (i < s.size()) {
+            size_t zeros{ 0 };
+            while (i + zeros < s.size() && (s[i + zeros] ^ baseAt(base, i + zeros)) == std::byte{ 0 })
+                ++zeros;
+            i += zeros;
+
+            size_t literal{ 0 };
+            size_t run{ 0 };
+            while (i + literal < s.size() && run < MIN_ZERO_RUN) {
+                run = (s[i + literal] ^ baseAt(base, i + literal)) == std::byte{ 0 } ? run + 1 : 0;
+                ++literal;
+            }
+            literal -= run;
+
+            writeRun(out, static_cast<uint32_t>(zeros), static_cast<uint32_t>(literal));
+            for (size_t k{ 0 }; k < literal; ++k)
+                out.push_back(s[i + k] ^ baseAt(base, i + k));
+            i += literal;
+        }
+    }
+
+
+    void decodeDelta(const Snapshot& base, const std::vector<std::byte>& delta, size_t size, Snapshot& out) {
+        out.resize(size);
+        std::copy_n(base.begin(), std::min(base.size(), size), out.begin());
+        if (size > base.size())
+            std::fill(out.begin() + base.size(), out.end(), std::byte{ 0 });
+
+        size_t pos{ 0 };
+        size_t at{ 0 };
+        while (at < delta.size()) {
+            uint32_t zeros, literal;
+            std::memcpy(&zeros, delta.data() + at, sizeof(zeros));
+            std::memcpy(&literal, delta.data() + at + sizeof(zeros), sizeof(literal));
+            at += sizeof(zeros) + sizeof(literal);
+
+            pos += zeros;
+            for (uint32_t k{ 0 }; k < literal; ++k)
+                out[pos + k] ^= delta[at + k];
+            pos += literal;
+            at += literal;
+        }
+    }
+}
+
+
+RewindBuffer::RewindBuffer(size_t budgetBytes, size_t keyframeInterval)
+    : m_budget(budgetBytes)
+    , m_keyframeInterval(std::max<size_t>(1, keyframeInterval)) {
+    // pop() recycles while rewinding, which must not allocate
+    m_spare.reserve(MAX_SPARE_BUFFERS);
+}
+
+
+std::vector<std::byte> RewindBuffer::takeBuffer() {
+    if (m_spare.empty())
+        return {};
+    auto buffer = std::move(m_spare.back());
+    m_spare.pop_back();
+    return buffer;
+}
+
+
+void RewindBuffer::recycle(std::vector<std::byte>&& buffer) {
+    if (m_spare.size() < MAX_SPARE_BUFFERS)
+        m_spare.push_back(std::move(buffer));
+}
+
+
+void RewindBuffer::push(const Snapshot& s) {
+    Entry entry{ m_entries.empty() || m_sinceKeyframe >= m_keyframeInterval, s.size(), takeBuffer() };
+    if (entry.keyframe) {
+        entry.data.assign(s.begin(), s.end());
+        m_sinceKeyframe = 1;
+    }
+    else {
+        encodeDelta(keyframeOf(m_entries.size() - 1)->data, s, entry.data);
+        ++m_sinceKeyframe;
+    }
+
+    m_bytes += entry.data.size();
+    m_entries.push_back(std::move(entry));
+
+    // never drop the group being written to
+    while (m_bytes > m_budget && m_entries.size() > m_sinceKeyframe)
+        dropOldest();
+}
+
+
+bool RewindBuffer::pop(Snapshot& out) {
+    if (m_entries.empty())
+        return false;
+
+    const size_t last = m_entries.size() - 1;
+    auto& entry = m_entries[last];
+    if (entry.keyframe)
+        out.assign(entry.data.begin(), entry.data.end());
+    else
+        decodeDelta(keyframeOf(last)->data, entry.data, entry.size, out);
+
+    m_bytes -= entry.data.size();
+    recycle(std::move(entry.data));
+    m_entries.pop_back();
+
+    // the next push continues the group that is now at the back
+    m_sinceKeyframe = 0;
+    for (size_t i = m_entries.size(); i-- > 0; ) {
+        ++m_sinceKeyframe;
+        if (m_entries[i].keyframe)
+            break;
+    }
+    return true;
+}
+
+
+void RewindBuffer::clear() {
+    for (auto& entry : m_entries)
+        recycle(std::move(entry.data));
+    m_entries.clear();
+    m_bytes = 0;
+    m_sinceKeyframe = 0;
+}
+
+
+// the keyframe at the front goes, and every delta encoded against it
+void RewindBuffer::dropOldest() {
+    do {
+        m_bytes -= m_entries.front().data.size();
+        recycle(std::move(m_entries.front().data));
+        m_entries.pop_front();
+    } while (!m_entries.empty() && !m_entries.front().keyframe);
+}
+
+
+const RewindBuffer::Entry* RewindBuffer::keyframeOf(size_t idx) const {
+    while (!m_entries[idx].keyframe)
+        --idx;
+    return &m_entries[idx];
+}
\ No newline at end of file
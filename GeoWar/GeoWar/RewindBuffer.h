@@ -0,0 +1,49 @@
+#ifndef GEOWARS_REWINDBUFFER_H
+#define GEOWARS_REWINDBUFFER_H
+
+
+#include <deque>
+#include <vector>
+#include <cstddef>
+
+#include "Snapshot.h"
+
+
+// Snapshots kept for rewinding, bounded by a byte budget.
+// Every keyframeInterval-th snapshot is stored whole, the ones in between
+// as the XOR against their keyframe with the zero runs squeezed out, so a
+// frame where little moved costs a few bytes. When the budget runs out
+// the oldest keyframe is dropped together with its deltas.
+class RewindBuffer {
+private:
+    struct Entry {
+        bool                    keyframe;
+        size_t                  size;       // decoded size
+        std::vector<std::byte>  data;
+    };
+
+    std::deque<Entry>                   m_entries;
+    std::vector<std::vector<std::byte>> m_spare;        // buffers of dropped entries, reused
+    size_t                              m_budget;
+    size_t                              m_bytes{ 0 };
+    size_t                              m_keyframeInterval;
+    size_t                              m_sinceKeyframe{ 0 };
+
+    std::vector<std::byte>  takeBuffer();
+    void                    recycle(std::vector<std::byte>&& buffer);
+    void                    dropOldest();
+    const Entry*            keyframeOf(size_t idx) const;
+
+public:
+    explicit RewindBuffer(size_t budgetBytes, size_t keyframeInterval = 30);
+
+    void                    push(const Snapshot& s);
+    bool                    pop(Snapshot& out);     // newest first, false once empty
+    void                    clear();
+
+    size_t                  size() const { return m_entries.size(); }
+    size_t                  bytes() const { return m_bytes; }
+};
+
+
+#endif //GEOWARS_REWINDBUFFER_H
\ No newline at end of file
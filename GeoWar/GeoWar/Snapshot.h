@@ -0,0 +1,101 @@
+#ifndef GEOWARS_SNAPSHOT_H
+#define GEOWARS_SNAPSHOT_H
+
+
+#include <vector>
+#include <string>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <cassert>
+#include <type_traits>
+
+#include "Components.h"
+
+
+// World state as one flat byte blob. Trivially copyable data is copied as
+// raw bytes. Every GeoWar component is plain data, one that is not would
+// need saveComponent()/loadComponent() overloads, ComponentPool picks them
+// up by overload.
+using Snapshot = std::vector<std::byte>;
+
+
+class SnapshotWriter {
+private:
+    Snapshot&               m_blob;
+
+public:
+    explicit SnapshotWriter(Snapshot& blob) : m_blob(blob) {}
+
+    void writeBytes(const void* data, size_t n) {
+        auto bytes = static_cast<const std::byte*>(data);
+        m_blob.insert(m_blob.end(), bytes, bytes + n);
+    }
+
+
+    template<typename T>
+    void write(const T& value) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        writeBytes(&value, sizeof(T));
+    }
+
+
+    template<typename T>
+    void writeArray(const std::vector<T>& values) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        write(static_cast<uint32_t>(values.size()));
+        writeBytes(values.data(), values.size() * sizeof(T));
+    }
+
+
+    void writeString(const std::string& s) {
+        write(static_cast<uint32_t>(s.size()));
+        writeBytes(s.data(), s.size());
+    }
+};
+
+
+class SnapshotReader {
+private:
+    const std::byte*        m_pos;
+    const std::byte*        m_end;
+
+public:
+    explicit SnapshotReader(const Snapshot& blob)
+        : m_pos(blob.data()), m_end(blob.data() + blob.size()) {}
+
+    void readBytes(void* out, size_t n) {
+        assert(n <= static_cast<size_t>(m_end - m_pos));
+        if (n == 0)
+            return;
+        std::memcpy(out, m_pos, n);
+        m_pos += n;
+    }
+
+
+    template<typename T>
+    T read() {
+        static_assert(std::is_trivially_copyable_v<T>);
+        T value;
+        readBytes(&value, sizeof(T));
+        return value;
+    }
+
+
+    template<typename T>
+    void readArray(std::vector<T>& values) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        values.resize(read<uint32_t>());
+        readBytes(values.data(), values.size() * sizeof(T));
+    }
+
+
+    std::string readString() {
+        std::string s(read<uint32_t>(), '\0');
+        readBytes(s.data(), s.size());
+        return s;
+    }
+};
+
+
+#endif //GEOWARS_SNAPSHOT_H
\ No newline at end of file
@@ -0,0 +1,63 @@
+#include "SpatialHash.h"
+#include "MemoryTracker.h"
+#include <bit>
+
+
+uint32_t SpatialHash::bucket(int32_t cx, int32_t cy) const {
+    const uint32_t h = static_cast<uint32_t>(cx) * 73856093u ^ static_cast<uint32_t>(cy) * 19349663u;
+    return h & m_mask;
+}
+
+
+void SpatialHash::clear() {
+    m_items.clear();
+    m_maxRadius = 0.f;
+}
+
+
+void SpatialHash::insert(Entity e, sf::Vector2f pos, float radius) {
+    // more circles than any tick before, growing is allowed once per doubling
+    if (m_items.size() == m_items.capacity()) {
+        AllocationScope growth;
+        m_items.reserve(std::max<size_t>(64, 2 * m_items.size()));
+    }
+    m_items.push_back(Item{ pos, radius, 0, 0, e });
+    m_maxRadius = std::max(m_maxRadius, radius);
+}
+
+
+// counting sort by bucket, two passes over the circles and one over the table
+void SpatialHash::build() {
+    m_cellSize = std::max(2.f * m_maxRadius, 1.f);
+    m_invCellSize = 1.f / m_cellSize;
+
+    // about two buckets per circle keeps the shared buckets few
+    const uint32_t buckets = std::bit_ceil(static_cast<uint32_t>(std::max<size_t>(m_items.size() * 2, 16)));
+    m_mask = buckets - 1;
+    if (m_sorted.capacity() < m_items.capacity() || m_start.capacity() < buckets + 1) {
+        // the two item vectors trade places every build, they grow together
+        AllocationScope growth;
+        m_sorted.reserve(m_items.capacity());
+        m_start.reserve(std::bit_ceil(std::max<size_t>(m_items.capacity() * 2, 16)) + 1);
+    }
+    m_start.assign(buckets + 1, 0);
+
+    for (auto& item : m_items) {
+        item.cx = cell(item.pos.x);
+        item.cy = cell(item.pos.y);
+        ++m_start[bucket(item.cx, item.cy) + 1];
+    }
+    for (uint32_t b{ 0 }; b < buckets; ++b)
+        m_start[b + 1] += m_start[b];
+
+    // m_start[b] is the next free place of bucket b while scattering, which
+    // leaves it at the start of bucket b + 1; shift back afterwards
+    m_sorted.resize(m_items.size());
+    for (const auto& item : m_items)
+        m_sorted[m_start[bucket(item.cx, item.cy)]++] = item;
+    for (uint32_t b{ buckets }; b > 0; --b)
+        m_start[b] = m_start[b - 1];
+    m_start[0] = 0;
+
+    m_items.swap(m_sorted);
+}
\ No newline at end of file
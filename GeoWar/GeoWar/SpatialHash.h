@@ -0,0 +1,85 @@
+#ifndef GEOWARS_SPATIALHASH_H
+#define GEOWARS_SPATIALHASH_H
+
+
+#include <SFML/System/Vector2.hpp>
+#include <vector>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+
+#include "Entity.h"
+
+
+// Uniform grid broadphase for collision circles, rebuilt every tick.
+// Each circle goes in the one cell that holds its centre, cells are twice
+// the largest radius wide, so a query only has to look at the cells within
+// its own radius plus the largest one. The cells are hashed into a table
+// sized to the number of circles, which bounds the memory whatever the
+// extent of the world, and sorted by bucket so the circles of a cell are
+// contiguous. Buckets shared by several cells are told apart by the cell
+// coordinates kept with each circle.
+// The vectors keep their capacity, a grid stops allocating once it has
+// seen its largest tick.
+class SpatialHash {
+public:
+    struct Item {
+        sf::Vector2f        pos;
+        float               radius;
+        int32_t             cx, cy;
+        Entity              entity;
+    };
+
+private:
+    std::vector<Item>       m_items;        // insert order, then sorted by bucket
+    std::vector<Item>       m_sorted;
+    std::vector<uint32_t>   m_start;        // bucket b holds m_items[m_start[b], m_start[b + 1])
+    uint32_t                m_mask{ 0 };    // buckets - 1, a power of two
+    float                   m_cellSize{ 1.f };
+    float                   m_invCellSize{ 1.f };
+    float                   m_maxRadius{ 0.f };
+
+    int32_t                 cell(float v) const { return static_cast<int32_t>(std::floor(v * m_invCellSize)); }
+    uint32_t                bucket(int32_t cx, int32_t cy) const;
+
+public:
+    void                    clear();
+    void                    insert(Entity e, sf::Vector2f pos, float radius);
+
+    // sorts the inserted circles into their cells, before any query
+    void                    build();
+
+    size_t                  size() const { return m_items.size(); }
+    float                   cellSize() const { return m_cellSize; }
+
+    // f(const Item&) for every circle in the cells a circle at pos with
+    // the given radius could overlap, each circle at most once; the
+    // narrowphase is up to f
+    template<typename F>
+    void                    query(sf::Vector2f pos, float radius, F&& f) const;
+};
+
+
+template<typename F>
+void SpatialHash::query(sf::Vector2f pos, float radius, F&& f) const {
+    if (m_items.empty())
+        return;
+
+    const float reach = radius + m_maxRadius;
+    const int32_t x0 = cell(pos.x - reach), x1 = cell(pos.x + reach);
+    const int32_t y0 = cell(pos.y - reach), y1 = cell(pos.y + reach);
+
+    for (int32_t cy{ y0 }; cy <= y1; ++cy) {
+        for (int32_t cx{ x0 }; cx <= x1; ++cx) {
+            const uint32_t b = bucket(cx, cy);
+            for (uint32_t i{ m_start[b] }; i < m_start[b + 1]; ++i) {
+                const Item& item = m_items[i];
+                if (item.cx == cx && item.cy == cy)
+                    f(item);
+            }
+        }
+    }
+}
+
+
+#endif //GEOWARS_SPATIALHASH_H
\ No newline at end of file
@@ -0,0 +1,167 @@
+#ifndef GEOWARS_SYSTEMSCHEDULER_H
+#define GEOWARS_SYSTEMSCHEDULER_H
+
+
+#include <vector>
+#include <string>
+#include <tuple>
+#include <memory>
+#include <optional>
+#include <functional>
+#include <algorithm>
+#include <type_traits>
+#include <cstdint>
+
+#include <SFML/System/Time.hpp>
+
+#include "Components.h"
+#include "EntityManager.h"
+#include "JobSystem.h"
+
+
+// the components a system reads and writes, checked against ComponentTuple
+template<typename... Ts> struct Reads {};
+template<typename... Ts> struct Writes {};
+
+
+// one bit per type in ComponentTuple
+using ComponentMask = uint64_t;
+static_assert(std::tuple_size_v<ComponentTuple> <= 64, "ComponentMask has one bit per component");
+
+template<typename T, typename Tuple> struct ComponentIndex;
+template<typename T> struct ComponentIndex<T, std::tuple<>> {
+    static_assert(sizeof(T) == 0, "component is not in ComponentTuple");
+};
+template<typename T, typename... Ts> struct ComponentIndex<T, std::tuple<T, Ts...>> {
+    static constexpr size_t value = 0;
+};
+template<typename T, typename U, typename... Ts> struct ComponentIndex<T, std::tuple<U, Ts...>> {
+    static constexpr size_t value = 1 + ComponentIndex<T, std::tuple<Ts...>>::value;
+};
+
+// mask of the types in Reads<...>, Writes<...> or View<...>
+template<typename List> struct MaskOf;
+template<template<typename...> class L, typename... Ts> struct MaskOf<L<Ts...>> {
+    static constexpr ComponentMask value =
+        (ComponentMask{ 0 } | ... | (ComponentMask{ 1 } << ComponentIndex<Ts, ComponentTuple>::value));
+};
+
+template<typename T> struct IsReads : std::false_type {};
+template<typename... Ts> struct IsReads<Reads<Ts...>> : std::true_type {};
+template<typename T> struct IsWrites : std::false_type {};
+template<typename... Ts> struct IsWrites<Writes<Ts...>> : std::true_type {};
+
+
+// Runs the systems of a scene once per update. Every system declares what
+// it reads and writes; run() orders a system after each earlier system it
+// conflicts with (one writes what the other touches) and runs the rest
+// side by side on the JobSystem. Systems added with addEach() are split
+// into chunks of entities that run in parallel as well.
+//
+// Systems other than exclusive ones may run on JobSystem workers and must
+// not spawn or destroy directly, they get a CommandBuffer for that.
+// Exclusive systems run alone, inline on the thread that calls run() (the
+// simulation thread), and may do anything, scene state and sound included.
+class SystemScheduler {
+public:
+    using SystemFn = std::function<void(sf::Time dt)>;
+
+    static constexpr size_t DEFAULT_CHUNK_SIZE{ 1024 };
+
+private:
+    struct System {
+        std::string         name;
+        ComponentMask       reads{ 0 };
+        ComponentMask       writes{ 0 };
+        bool                exclusive{ false };
+        bool                enabled{ true };
+        std::function<size_t()> prepare;    // once per run(), returns the number of items to split
+        std::function<void(sf::Time, size_t first, size_t last, CommandBuffer&)> run;
+    };
+
+    // one chunk of a system, plain data so queueing it never allocates
+    struct Task {
+        System*             system{ nullptr };
+        size_t              first{ 0 };
+        size_t              last{ 0 };
+        CommandBuffer*      commands{ nullptr };
+    };
+
+    EntityManager&              m_entityManager;
+    std::vector<System>         m_systems;
+    size_t                      m_chunkSize{ DEFAULT_CHUNK_SIZE };
+    std::vector<size_t>         m_level;            // per system, rebuilt by run()
+    std::vector<Task>           m_tasks;            // the chunks of one level
+
+    void                        addSystem(System system);
+    static bool                 conflicts(const System& a, const System& b);
+
+public:
+    explicit SystemScheduler(EntityManager& entityManager);
+
+    SystemScheduler(const SystemScheduler&) = delete;
+    SystemScheduler& operator=(const SystemScheduler&) = delete;
+
+    // fn(dt) once per run()
+    template<typename R, typename W>
+    void add(const std::string& name, SystemFn fn);
+
+    // fn(dt) alone on the calling thread, ordered against every other system
+    void addExclusive(const std::string& name, SystemFn fn);
+
+    // fn(dt, commands, entity, Ts&...) for every entity in the view makeView()
+    // returns, in chunks. Each chunk records into its own CommandBuffer.
+    template<typename R, typename W, typename MakeView, typename F>
+    void addEach(const std::string& name, MakeView makeView, F fn);
+
+    void                        setEnabled(const std::string& name, bool enabled);
+    void                        setChunkSize(size_t n) { m_chunkSize = std::max<size_t>(1, n); }
+
+    void                        run(sf::Time dt);
+};
+
+
+template<typename R, typename W>
+void SystemScheduler::add(const std::string& name, SystemFn fn) {
+    static_assert(IsReads<R>::value, "first list must be Reads<...>");
+    static_assert(IsWrites<W>::value, "second list must be Writes<...>");
+
+    System system;
+    system.name = name;
+    system.reads = MaskOf<R>::value;
+    system.writes = MaskOf<W>::value;
+    system.prepare = [] { return size_t{ 1 }; };
+    system.run = [fn = std::move(fn)](sf::Time dt, size_t, size_t, CommandBuffer&) { fn(dt); };
+    addSystem(std::move(system));
+}
+
+
+template<typename R, typename W, typename MakeView, typename F>
+void SystemScheduler::addEach(const std::string& name, MakeView makeView, F fn) {
+    using ViewType = std::invoke_result_t<MakeView>;
+    static_assert(IsReads<R>::value, "first list must be Reads<...>");
+    static_assert(IsWrites<W>::value, "second list must be Writes<...>");
+    static_assert((MaskOf<ViewType>::value & ~(MaskOf<R>::value | MaskOf<W>::value)) == 0,
+        "every component of the view must be in Reads<...> or Writes<...>");
+
+    // the view of the current run(), chunks only read it
+    auto view = std::make_shared<std::optional<ViewType>>();
+
+    System system;
+    system.name = name;
+    system.reads = MaskOf<R>::value | MaskOf<ViewType>::value;
+    system.writes = MaskOf<W>::value;
+    system.prepare = [view, makeView = std::move(makeView)] {
+        view->emplace(makeView());
+        return (*view)->extent();
+    };
+    system.run = [view, fn = std::move(fn)](sf::Time dt, size_t first, size_t last, CommandBuffer& commands) {
+        (*view)->eachInRange(first, last, [&](Entity e, auto&... components) {
+            fn(dt, commands, e, components...);
+            });
+    };
+    addSystem(std::move(system));
+}
+
+
+#endif //GEOWARS_SYSTEMSCHEDULER_H
\ No newline at end of file
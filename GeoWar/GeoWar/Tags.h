@@ -0,0 +1,57 @@
+#ifndef GEOWARS_TAGS_H
+#define GEOWARS_TAGS_H
+
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+
+using TagId = uint16_t;
+
+
+// tags known at compile time, the id doubles as the EntityManager bucket index
+namespace Tag {
+    enum : TagId {
+        Default = 0,
+        player,
+        bullet,
+        largeEnemy,
+        smallEnemy,
+        Count
+    };
+}
+
+
+// Interns tag names to small integer ids.
+// The compile time tags are registered first, in enum order, so
+// intern("bullet") == Tag::bullet. Only call intern() at registration time,
+// per frame code should hold on to the TagId.
+class TagRegistry {
+private:
+    // singleton class
+    TagRegistry();
+    ~TagRegistry() = default;
+
+public:
+    static TagRegistry& getInstance();
+
+    // no copy or move
+    TagRegistry(const TagRegistry&) = delete;
+    TagRegistry(TagRegistry&&) = delete;
+    TagRegistry& operator=(const TagRegistry&) = delete;
+    TagRegistry& operator=(TagRegistry&&) = delete;
+
+private:
+    std::vector<std::string>                    m_names;
+    std::unordered_map<std::string, TagId>      m_ids;
+
+public:
+    TagId                   intern(const std::string& name);
+    const std::string&      getName(TagId id) const;
+    size_t                  size() const;
+};
+
+
+#endif //GEOWARS_TAGS_H
@@ -0,0 +1,47 @@
+#ifndef GEOWARS_TRIPLEBUFFER_H
+#define GEOWARS_TRIPLEBUFFER_H
+
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+
+// Hands the newest value from one producer thread to one consumer thread
+// without locks. The producer fills back() and publishes it, the consumer
+// takes the newest published buffer with acquire() and reads front().
+// Neither side ever waits for the other; frames the consumer was too slow
+// to see are overwritten.
+template<typename T>
+class TripleBuffer {
+private:
+    static constexpr uint8_t INDEX{ 0x3 };
+    static constexpr uint8_t FRESH{ 0x4 };     // the middle buffer has not been acquired yet
+
+    std::array<T, 3>        m_buffers;
+    std::atomic<uint8_t>    m_middle{ 1 };
+    uint8_t                 m_back{ 0 };        // producer only
+    uint8_t                 m_front{ 2 };       // consumer only
+
+public:
+    // producer
+    T&                      back() { return m_buffers[m_back]; }
+
+    void publish() {
+        m_back = m_middle.exchange(static_cast<uint8_t>(m_back | FRESH), std::memory_order_acq_rel) & INDEX;
+    }
+
+
+    // consumer, false if nothing new was published since the last call
+    bool acquire() {
+        if (!(m_middle.load(std::memory_order_relaxed) & FRESH))
+            return false;
+        m_front = m_middle.exchange(m_front, std::memory_order_acq_rel) & INDEX;
+        return true;
+    }
+
+    const T&                front() const { return m_buffers[m_front]; }
+};
+
+
+#endif //GEOWARS_TRIPLEBUFFER_H
\ No newline at end of file
@@ -0,0 +1,590 @@
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "Animation.h"
+#include "Assets.h"
+#include "EntityManager.h"
+#include "Lanes.h"
+#include "MusicPlayer.h"
+#include "Physics.h"
+#include "SoundPlayer.h"
+#include "Utilities.h"
+
+
+// Fixed seeds and fixed worlds, so two runs do the same work and the
+// numbers only move when the code does.
+
+namespace {
+    Entity spawnCar(EntityManager& manager, std::mt19937& rng) {
+        std::uniform_real_distribution<float> position(0.f, 480.f);
+        std::uniform_real_distribution<float> speed(-120.f, 120.f);
+
+        auto e = manager.addEntity(Tag::car);
+        e.addComponent<CTransform>(sf::Vector2f(position(rng), position(rng)), sf::Vector2f(speed(rng), 0.f));
+        e.addComponent<CBoundingBox>(sf::Vector2f(40.f, 30.f));
+        return e;
+    }
+
+
+    // the loaders report every frame set and animation, keep that out of the timing
+    class SilenceCout {
+    private:
+        std::ostringstream  m_sink;
+        std::streambuf*     m_previous;
+
+    public:
+        SilenceCout() : m_previous(std::cout.rdbuf(m_sink.rdbuf())) {}
+        ~SilenceCout() { std::cout.rdbuf(m_previous); }
+    };
+}
+
+
+// range(0) live entities, a tenth of them destroyed and replaced before every update
+static void BM_EntityManagerUpdateChurn(benchmark::State& state) {
+    const size_t live = static_cast<size_t>(state.range(0));
+    const size_t churn = std::max<size_t>(1, live / 10);
+
+    std::mt19937 rng(42);
+    EntityManager manager;
+    std::vector<Entity> entities;
+    for (size_t i{ 0 }; i < live; ++i)
+        entities.push_back(spawnCar(manager, rng));
+    manager.update();
+
+    std::uniform_int_distribution<size_t> pick(0, live - 1);
+    for (auto _ : state) {
+        for (size_t i{ 0 }; i < churn; ++i) {
+            auto& e = entities[pick(rng)];
+            e.destroy();
+            e = spawnCar(manager, rng);
+        }
+        manager.update();
+    }
+    state.SetItemsProcessed(state.iterations() * churn);
+}
+BENCHMARK(BM_EntityManagerUpdateChurn)->RangeMultiplier(10)->Range(1000, 100000)->Unit(benchmark::kMicrosecond);
+
+
+namespace {
+    // an entity as it was before the component pools: every component
+    // inline whether it is used or not, behind a shared_ptr, tagged by name
+    struct InlineEntity {
+        size_t              id{ 0 };
+        std::string         tag;
+        bool                active{ true };
+        ComponentTuple      components{};
+
+        template<typename T>
+        T& get() { return std::get<T>(components); }
+    };
+}
+
+
+// One update of the animation and movement systems over 100k cars, each
+// with a transform, an animation and a bounding box. range(0) 0 walks the
+// old per-entity layout the way the systems used to, 1 the views the
+// scheduler hands them now.
+static void BM_MovementAnimationPass(benchmark::State& state) {
+    constexpr size_t COUNT{ 100000 };
+    static const sf::Texture texture;
+    static const std::vector<sf::IntRect> frames{
+        { 0, 0, 40, 40 }, { 40, 0, 40, 40 }, { 80, 0, 40, 40 }, { 120, 0, 40, 40 } };
+    Animation animation;
+    {
+        SilenceCout quiet;
+        animation = Animation("bench", texture, frames, sf::seconds(1.f / 8.f));
+    }
+
+    std::mt19937 rng(42);
+    EntityManager manager;
+    std::vector<std::shared_ptr<InlineEntity>> inlineEntities;
+    for (size_t i{ 0 }; i < COUNT; ++i) {
+        auto e = spawnCar(manager, rng);
+        e.addComponent<CAnimation>(animation);
+
+        auto old = std::make_shared<InlineEntity>(InlineEntity{ i, "car" });
+        old->get<CTransform>() = e.getComponent<CTransform>();
+        old->get<CBoundingBox>() = e.getComponent<CBoundingBox>();
+        old->get<CAnimation>() = e.getComponent<CAnimation>();
+        inlineEntities.push_back(std::move(old));
+    }
+    manager.update();
+
+    const sf::Time dt = sf::seconds(1.f / 60.f);
+    for (auto _ : state) {
+        if (state.range(0) == 0) {
+            for (auto& e : inlineEntities) {
+                if (!e->get<CAnimation>().has)
+                    continue;
+                if (e->tag == "turtles" && e->get<CState>().state != "animated")
+                    continue;
+                e->get<CAnimation>().animation.update(dt);
+            }
+            for (auto& e : inlineEntities) {
+                if (e->get<CInput>().has || !e->get<CTransform>().has)
+                    continue;
+                auto& tfm = e->get<CTransform>();
+                tfm.prevPos = tfm.pos;
+                tfm.pos += tfm.vel * dt.asSeconds();
+                tfm.angle += tfm.angVel * dt.asSeconds();
+            }
+        }
+        else {
+            manager.view<CAnimation>().each([dt](Entity e, CAnimation& anim) {
+                if (e.getTag() == Tag::turtles && e.getComponent<CState>().state != "animated")
+                    return;
+                anim.animation.update(dt);
+                });
+            manager.view<CTransform>().each([dt](Entity e, CTransform& tfm) {
+                if (e.hasComponent<CInput>())
+                    return;
+                tfm.prevPos = tfm.pos;
+                tfm.pos += tfm.vel * dt.asSeconds();
+                tfm.angle += tfm.angVel * dt.asSeconds();
+                });
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * COUNT);
+    state.SetLabel(state.range(0) ? "pools" : "inline");
+}
+BENCHMARK(BM_MovementAnimationPass)->Arg(0)->Arg(1)->Unit(benchmark::kMicrosecond);
+
+
+static void BM_PhysicsGetOverlap(benchmark::State& state) {
+    std::mt19937 rng(42);
+    EntityManager manager;
+    std::vector<Entity> entities;
+    for (size_t i{ 0 }; i < 1024; ++i)
+        entities.push_back(spawnCar(manager, rng));
+    manager.update();
+
+    size_t i{ 0 };
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(Physics::getOverlap(entities[i % 1024], entities[(i + 1) % 1024]));
+        ++i;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_PhysicsGetOverlap);
+
+
+// ten lanes of four obstacles like Scene_Frogger's, each position looked up
+// at a random time to show a seek costs the same wherever it lands
+static void BM_LanesSeek(benchmark::State& state) {
+    EntityManager manager;
+    Lanes lanes;
+    for (int i{ 0 }; i < 10; ++i)
+        lanes.add(Tag::car, manager.instantiate(Prefab(Tag::car), 4), sf::Vector2f(100.f, 40.f * i),
+            150.f, i % 2 ? 40.f : -60.f, sf::Vector2f(35.f, 7.5f), 480.f, 20.f);
+
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<sf::Int64> time(0, 3600 * 1000000LL);
+    for (auto _ : state) {
+        const sf::Time t = sf::microseconds(time(rng));
+        for (const auto& lane : lanes.lanes())
+            for (const auto& obstacle : lanes.obstacles(lane))
+                benchmark::DoNotOptimize(lanes.x(lane, obstacle, t));
+    }
+    state.SetItemsProcessed(state.iterations() * 40);
+}
+BENCHMARK(BM_LanesSeek);
+
+
+// when the next of four cars reaches the frog, which lets the scene skip
+// its tests until then
+static void BM_LanesContact(benchmark::State& state) {
+    EntityManager manager;
+    Lanes lanes;
+    lanes.add(Tag::car, manager.instantiate(Prefab(Tag::car), 4), sf::Vector2f(100.f, 0.f),
+        150.f, -60.f, sf::Vector2f(35.f, 7.5f), 480.f, 20.f);
+
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> x(20.f, 460.f);
+    std::uniform_int_distribution<sf::Int64> time(0, 3600 * 1000000LL);
+    for (auto _ : state)
+        benchmark::DoNotOptimize(lanes.contact(lanes.lanes().front(), x(rng), 7.5f, sf::microseconds(time(rng))));
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LanesContact);
+
+
+namespace {
+    // the same boxes as entities and as proxies
+    struct Boxes {
+        EntityManager           manager;
+        std::vector<Entity>     entities;
+        CollisionProxies        proxies;
+
+        explicit Boxes(size_t n) {
+            std::mt19937 rng(42);
+            for (size_t i{ 0 }; i < n; ++i) {
+                auto e = spawnCar(manager, rng);
+                entities.push_back(e);
+                proxies.add(CollisionProxy{ e.getComponent<CTransform>().pos, e.getComponent<CBoundingBox>().halfSize });
+            }
+            manager.update();
+        }
+    };
+}
+
+
+// one box against range(0) others, a pair at a time through the entities
+static void BM_PhysicsGetOverlapOneVsMany(benchmark::State& state) {
+    Boxes boxes(static_cast<size_t>(state.range(0)) + 1);
+    for (auto _ : state)
+        for (size_t i{ 1 }; i < boxes.entities.size(); ++i)
+            benchmark::DoNotOptimize(Physics::getOverlap(boxes.entities[0], boxes.entities[i]));
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_PhysicsGetOverlapOneVsMany)->RangeMultiplier(8)->Range(64, 4096);
+
+
+// the same with the batch kernel on proxies
+static void BM_PhysicsOverlapOneVsMany(benchmark::State& state) {
+    Boxes boxes(static_cast<size_t>(state.range(0)) + 1);
+    const CollisionProxy one = boxes.proxies[0];
+    std::vector<uint64_t> hits;
+    for (auto _ : state) {
+        Physics::overlapOneVsMany(Physics::Shape::Box, one, boxes.proxies, Physics::ALL_LAYERS, hits);
+        benchmark::DoNotOptimize(hits.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_PhysicsOverlapOneVsMany)->RangeMultiplier(8)->Range(64, 4096);
+
+
+// every pair of range(0) boxes, as boxes and as circles
+static void BM_PhysicsGetOverlapManyVsMany(benchmark::State& state) {
+    Boxes boxes(static_cast<size_t>(state.range(0)));
+    for (auto _ : state)
+        for (auto a : boxes.entities)
+            for (auto b : boxes.entities)
+                benchmark::DoNotOptimize(Physics::getOverlap(a, b));
+    state.SetItemsProcessed(state.iterations() * state.range(0) * state.range(0));
+}
+BENCHMARK(BM_PhysicsGetOverlapManyVsMany)->RangeMultiplier(4)->Range(64, 1024);
+
+
+static void BM_PhysicsOverlapManyVsMany(benchmark::State& state) {
+    Boxes boxes(static_cast<size_t>(state.range(0)));
+    const auto shape = state.range(1) ? Physics::Shape::Circle : Physics::Shape::Box;
+    std::vector<uint64_t> hits;
+    for (auto _ : state) {
+        Physics::overlapManyVsMany(shape, boxes.proxies, boxes.proxies, hits);
+        benchmark::DoNotOptimize(hits.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0) * state.range(0));
+    state.SetLabel(state.range(1) ? "circle" : "box");
+}
+BENCHMARK(BM_PhysicsOverlapManyVsMany)->ArgsProduct({ { 64, 256, 1024 }, { 0, 1 } });
+
+
+namespace {
+    // boxes that drift sideways and wrap, as entities in a Physics::World
+    // and as plain boxes for the brute force
+    struct Scene {
+        EntityManager           manager;
+        std::vector<Entity>     entities;
+        std::vector<AABB>       boxes;
+        std::vector<float>      velocities;     // 0 for the ones that stand still
+        float                   width;
+        Physics::World          world;
+
+        explicit Scene(float width) : width(width) {}
+
+        void add(sf::Vector2f center, sf::Vector2f halfSize, float velocity) {
+            auto e = manager.addEntity(Tag::car);
+            entities.push_back(e);
+            boxes.push_back(AABB::around(center, halfSize));
+            velocities.push_back(velocity);
+            world.add(e, boxes.back());
+        }
+
+        // one 60 Hz update
+        void step() {
+            for (size_t i{ 0 }; i < boxes.size(); ++i) {
+                if (velocities[i] == 0.f)
+                    continue;
+                sf::Vector2f d(velocities[i] / 60.f, 0.f);
+                AABB& box = boxes[i];
+                if (box.min.x + d.x > width)
+                    d.x -= width + (box.max.x - box.min.x);
+                else if (box.max.x + d.x < 0.f)
+                    d.x += width + (box.max.x - box.min.x);
+                box.min += d;
+                box.max += d;
+                world.update(entities[i], box, std::abs(d.x) > width / 2.f ? sf::Vector2f() : d);
+            }
+        }
+
+        void bruteForcePairs(std::vector<Physics::World::Pair>& out) const {
+            out.clear();
+            for (size_t i{ 0 }; i < boxes.size(); ++i)
+                for (size_t j{ i + 1 }; j < boxes.size(); ++j)
+                    if (boxes[i].overlaps(boxes[j]))
+                        out.emplace_back(entities[i], entities[j]);
+        }
+
+        void bruteForceBox(const AABB& region, std::vector<Entity>& out) const {
+            out.clear();
+            for (size_t i{ 0 }; i < boxes.size(); ++i)
+                if (boxes[i].overlaps(region))
+                    out.push_back(entities[i]);
+        }
+
+        std::optional<Physics::RayHit> bruteForceRaycast(sf::Vector2f from, sf::Vector2f to) const {
+            std::optional<Physics::RayHit> first;
+            float limit{ 1.f };
+            for (size_t i{ 0 }; i < boxes.size(); ++i) {
+                if (const auto t = boxes[i].raycast(from, to, limit)) {
+                    limit = *t;
+                    first = Physics::RayHit{ entities[i], *t, from + *t * (to - from) };
+                }
+            }
+            return first;
+        }
+    };
+
+
+    // Scene_Frogger's ten lanes, the five goals and the frog
+    void buildLevel(Scene& scene) {
+        struct Row { float x, y, velocity, spacing; int count; sf::Vector2f size; };
+        const Row rows[]{
+            { 150.f, 540.f, -40.f, 150.f, 3, { 30.f, 15.f } },
+            { 300.f, 500.f, 40.f, -150.f, 3, { 30.f, 15.f } },
+            { 150.f, 460.f, -50.f, 150.f, 3, { 30.f, 15.f } },
+            { 300.f, 420.f, 60.f, -150.f, 3, { 30.f, 15.f } },
+            { 240.f, 380.f, -70.f, 200.f, 2, { 50.f, 15.f } },
+            { 100.f, 300.f, -40.f, 150.f, 4, { 80.f, 15.f } },
+            { 400.f, 260.f, 40.f, -175.f, 3, { 70.f, 15.f } },
+            { 400.f, 220.f, 60.f, -230.f, 3, { 170.f, 15.f } },
+            { 175.f, 180.f, -40.f, 130.f, 4, { 50.f, 15.f } },
+            { 350.f, 140.f, 50.f, -175.f, 3, { 70.f, 15.f } },
+        };
+        for (const auto& row : rows)
+            for (int i{ 0 }; i < row.count; ++i)
+                scene.add(sf::Vector2f(row.x + i * row.spacing, row.y), 0.5f * row.size, row.velocity);
+        for (int i{ 0 }; i < 5; ++i)
+            scene.add(sf::Vector2f(36.f + 102.f * i, 100.f), sf::Vector2f(10.f, 10.f), 0.f);
+        scene.add(sf::Vector2f(240.f, 580.f), sf::Vector2f(7.5f, 7.5f), 0.f);
+        scene.manager.update();
+    }
+
+
+    // n boxes from 15 to 170 wide and 15 to 40 high over a square about
+    // a third full, a tenth of them moving
+    void buildSynthetic(Scene& scene, size_t n) {
+        std::mt19937 rng(42);
+        std::uniform_real_distribution<float> position(0.f, scene.width);
+        std::uniform_real_distribution<float> width(15.f, 170.f);
+        std::uniform_real_distribution<float> height(15.f, 40.f);
+        std::uniform_real_distribution<float> speed(-120.f, 120.f);
+        std::bernoulli_distribution moving(0.1);
+        for (size_t i{ 0 }; i < n; ++i)
+            scene.add(sf::Vector2f(position(rng), position(rng)), 0.5f * sf::Vector2f(width(rng), height(rng)),
+                moving(rng) ? speed(rng) : 0.f);
+        scene.manager.update();
+    }
+
+    float syntheticWidth(size_t n) {
+        return std::sqrt(static_cast<float>(n) * 8000.f);
+    }
+}
+
+
+// all overlapping pairs of the level after every update, through the tree
+// and with the brute force
+static void BM_WorldPairsLevel(benchmark::State& state) {
+    Scene scene(480.f);
+    buildLevel(scene);
+    std::vector<Physics::World::Pair> pairs;
+    for (auto _ : state) {
+        scene.step();
+        if (state.range(0))
+            scene.bruteForcePairs(pairs);
+        else
+            scene.world.pairs(pairs);
+        benchmark::DoNotOptimize(pairs.data());
+    }
+    state.SetItemsProcessed(state.iterations() * scene.boxes.size());
+    state.SetLabel(state.range(0) ? "brute force" : "tree");
+}
+BENCHMARK(BM_WorldPairsLevel)->Arg(0)->Arg(1);
+
+
+// The same on range(0) synthetic boxes. The brute force stops at 8192,
+// 50k would take seconds an update.
+static void BM_WorldPairsSynthetic(benchmark::State& state) {
+    const auto n = static_cast<size_t>(state.range(0));
+    Scene scene(syntheticWidth(n));
+    buildSynthetic(scene, n);
+    std::vector<Physics::World::Pair> pairs;
+    for (auto _ : state) {
+        scene.step();
+        if (state.range(1))
+            scene.bruteForcePairs(pairs);
+        else
+            scene.world.pairs(pairs);
+        benchmark::DoNotOptimize(pairs.data());
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+    state.SetLabel(state.range(1) ? "brute force" : "tree");
+}
+BENCHMARK(BM_WorldPairsSynthetic)->Args({ 1024, 0 })->Args({ 8192, 0 })->Args({ 50000, 0 })
+    ->Args({ 1024, 1 })->Args({ 8192, 1 })->Unit(benchmark::kMicrosecond);
+
+
+// updating the synthetic scene alone, most moves stay inside their fat box
+static void BM_WorldUpdateSynthetic(benchmark::State& state) {
+    Scene scene(syntheticWidth(50000));
+    buildSynthetic(scene, 50000);
+    for (auto _ : state)
+        scene.step();
+    state.SetItemsProcessed(state.iterations() * 5000);
+    state.counters["height"] = static_cast<double>(scene.world.tree().height());
+}
+BENCHMARK(BM_WorldUpdateSynthetic)->Unit(benchmark::kMicrosecond);
+
+
+// a 200 by 200 region, a point and a 1000 long ray at random places in the
+// 50k scene, range(1) picks the brute force
+static void BM_WorldQuerySynthetic(benchmark::State& state) {
+    Scene scene(syntheticWidth(50000));
+    buildSynthetic(scene, 50000);
+    const bool bruteForce = state.range(1);
+
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> position(0.f, scene.width);
+    std::uniform_real_distribution<float> angle(0.f, 6.2831853f);
+    std::vector<Entity> found;
+    for (auto _ : state) {
+        const sf::Vector2f p(position(rng), position(rng));
+        switch (state.range(0)) {
+        case 0:
+            if (bruteForce)
+                scene.bruteForceBox(AABB::around(p, sf::Vector2f(100.f, 100.f)), found);
+            else
+                scene.world.queryBox(AABB::around(p, sf::Vector2f(100.f, 100.f)), found);
+            benchmark::DoNotOptimize(found.data());
+            break;
+        case 1:
+            if (bruteForce)
+                scene.bruteForceBox(AABB{ p, p }, found);
+            else
+                scene.world.queryPoint(p, found);
+            benchmark::DoNotOptimize(found.data());
+            break;
+        default: {
+            const float a = angle(rng);
+            const sf::Vector2f to = p + 1000.f * sf::Vector2f(std::cos(a), std::sin(a));
+            benchmark::DoNotOptimize(bruteForce ? scene.bruteForceRaycast(p, to) : scene.world.raycast(p, to));
+            break;
+        }
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+    static const char* names[]{ "box", "point", "ray" };
+    state.SetLabel(std::string(names[state.range(0)]) + (bruteForce ? ", brute force" : ", tree"));
+}
+BENCHMARK(BM_WorldQuerySynthetic)->ArgsProduct({ { 0, 1, 2 }, { 0, 1 } });
+
+
+// range(0) animations advanced by one 60 Hz update
+static void BM_AnimationUpdate(benchmark::State& state) {
+    static const sf::Texture texture;
+    static const std::vector<sf::IntRect> frames{
+        { 0, 0, 40, 40 }, { 40, 0, 40, 40 }, { 80, 0, 40, 40 }, { 120, 0, 40, 40 } };
+
+    std::vector<Animation> animations;
+    {
+        SilenceCout quiet;
+        animations.assign(static_cast<size_t>(state.range(0)), Animation("bench", texture, frames, sf::seconds(1.f / 8.f)));
+    }
+
+    const sf::Time dt = sf::seconds(1.f / 60.f);
+    for (auto _ : state) {
+        for (auto& animation : animations)
+            animation.update(dt);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_AnimationUpdate)->RangeMultiplier(8)->Range(64, 32768);
+
+
+// headless, textures are not decoded into GPU memory and sounds not opened,
+// build hosts have neither
+static void BM_AssetsLoadFromFile(benchmark::State& state) {
+    SilenceCout quiet;
+    for (auto _ : state)
+        Assets::getInstance().loadFromFile("../config.txt", true);
+}
+BENCHMARK(BM_AssetsLoadFromFile)->Unit(benchmark::kMillisecond);
+
+
+namespace {
+    std::vector<sf::Vector2f> randomVectors() {
+        std::mt19937 rng(42);
+        std::uniform_real_distribution<float> d(-500.f, 500.f);
+        std::vector<sf::Vector2f> v(1024);
+        for (auto& p : v)
+            p = sf::Vector2f(d(rng), d(rng));
+        return v;
+    }
+}
+
+
+static void BM_UtilitiesNormalize(benchmark::State& state) {
+    const auto v = randomVectors();
+    for (auto _ : state)
+        for (const auto& p : v)
+            benchmark::DoNotOptimize(normalize(p));
+    state.SetItemsProcessed(state.iterations() * v.size());
+}
+BENCHMARK(BM_UtilitiesNormalize);
+
+
+static void BM_UtilitiesLengthAndDist(benchmark::State& state) {
+    const auto v = randomVectors();
+    for (auto _ : state)
+        for (size_t i{ 1 }; i < v.size(); ++i) {
+            benchmark::DoNotOptimize(length(v[i]));
+            benchmark::DoNotOptimize(dist(v[i - 1], v[i]));
+        }
+    state.SetItemsProcessed(state.iterations() * (v.size() - 1));
+}
+BENCHMARK(BM_UtilitiesLengthAndDist);
+
+
+static void BM_UtilitiesBearing(benchmark::State& state) {
+    const auto v = randomVectors();
+    for (auto _ : state)
+        for (const auto& p : v)
+            benchmark::DoNotOptimize(uVecBearing(bearing(p)));
+    state.SetItemsProcessed(state.iterations() * v.size());
+}
+BENCHMARK(BM_UtilitiesBearing);
+
+
+int main(int argc, char** argv) {
+    // config.txt and the assets are found relative to the project directory
+    std::filesystem::current_path(FROGGER_DIR);
+    SoundPlayer::useNullBackend();
+    MusicPlayer::useNullBackend();
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv))
+        return 1;
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,79 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <random>
+#include <vector>
+
+#include "Game.h"
+
+
+// Game keeps its systems private, the benchmarks get in as a friend.
+struct GameBenchmark {
+    // Enemies and bullets shuffled on a lattice right of the window, the
+    // player stays inside it. Neighbours are closer than a grid cell but
+    // further apart than their radii, so the broadphase finds pairs, none
+    // of them hits, the world stays the same and every run does the same
+    // tests.
+    static void populate(Game& game, size_t enemies, size_t bullets) {
+        constexpr float SPACING{ 30.f };     // more than 16 + 10
+        std::mt19937 rng(42);
+
+        std::vector<TagId> tags;
+        for (size_t i{ 0 }; i < enemies; ++i)
+            tags.push_back(i % 2 ? Tag::smallEnemy : Tag::largeEnemy);
+        tags.insert(tags.end(), bullets, Tag::bullet);
+        std::shuffle(tags.begin(), tags.end(), rng);
+
+        const size_t columns = static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(tags.size()))));
+        const float left = static_cast<float>(game.m_windowSize.x) + 100.f;
+        for (size_t i{ 0 }; i < tags.size(); ++i) {
+            const sf::Vector2f pos(left + SPACING * (i % columns), SPACING * (i / columns));
+            auto e = game.m_entityManager.addEntity(tags[i]);
+            e.addComponent<CTransform>(pos, sf::Vector2f(0.f, 0.f));
+            e.addComponent<CCollision>(tags[i] == Tag::bullet ? 10.f : 16.f);
+            e.addComponent<CScore>(100);
+        }
+        game.m_entityManager.update();
+    }
+
+    static void collide(Game& game) {
+        game.sCollision();
+    }
+};
+
+
+// range(0) enemies, half of them large, and range(1) bullets; 60 Hz
+// leaves 16.7 ms for the whole update
+static void BM_GameSCollision(benchmark::State& state) {
+    const size_t enemies = static_cast<size_t>(state.range(0));
+    const size_t bullets = static_cast<size_t>(state.range(1));
+    Game game("../config.txt", true);
+    GameBenchmark::populate(game, enemies, bullets);
+
+    PerfCounters::take(PerfCounters::CollisionTests);
+    for (auto _ : state)
+        GameBenchmark::collide(game);
+
+    state.counters["entities"] = static_cast<double>(enemies + bullets);
+    state.counters["pairs"] = benchmark::Counter(static_cast<double>(PerfCounters::take(PerfCounters::CollisionTests)),
+        benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_GameSCollision)
+    ->Args({ 64, 16 })->Args({ 256, 64 })->Args({ 1024, 256 })->Args({ 4096, 1024 })
+    ->Args({ 10000, 10000 })
+    ->Unit(benchmark::kMicrosecond);
+
+
+int main(int argc, char** argv) {
+    // config.txt and the font are found relative to the project directory
+    std::filesystem::current_path(GEOWAR_DIR);
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv))
+        return 1;
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}